@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>      // For timing
+#include <cstddef>     // For size_t
+#include <cstdint>     // For the fixed seed
+#include <type_traits> // For std::invoke_result_t
+#include <utility>     // For std::move
+
+#include "normal_sampler.hpp"
+#include "student.hpp"
+#include "student_table.hpp"
+
+// --- Shared benchmark helpers  ---
+// Every benchmark draws its scores from the same fixed seed, so runs and
+// benchmarks compare like with like.
+constexpr std::uint64_t BENCH_SEED = 20240501;
+
+// The score of row `row`: the normal draw the generator makes for it.
+inline auto bench_score(size_t row) -> double {
+  return sample_normal({.mean = SCORE_MEAN_CENTER, .stddev = SCORE_STD_DEV},
+                       BENCH_SEED, static_cast<std::uint32_t>(row), 0)
+      .value;
+}
+
+// Sets every score of `table` to bench_score of its row.
+template <typename Codec>
+void fill_bench_scores(BasicStudentTable<Codec> &table) {
+  for (size_t row = 0; row < table.size(); ++row) {
+    table.set_score(row, bench_score(row));
+  }
+}
+
+template <typename Result> struct BestRun {
+  double seconds;
+  Result result; // Reported, so the work cannot be optimized away
+};
+
+// Runs `run` `repeats` times and keeps the fastest pass with its result.
+template <typename Run>
+auto run_best_of(int repeats, Run run) -> BestRun<std::invoke_result_t<Run &>> {
+  BestRun<std::invoke_result_t<Run &>> best{.seconds = 0.0, .result = {}};
+  for (int repeat = 0; repeat < repeats; ++repeat) {
+    const auto start = std::chrono::steady_clock::now();
+    auto result = run();
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    if (repeat == 0 || elapsed.count() < best.seconds) {
+      best = {.seconds = elapsed.count(), .result = std::move(result)};
+    }
+  }
+  return best;
+}
+
+// Items per second.
+inline auto throughput(size_t items, double seconds) -> double {
+  return static_cast<double>(items) / seconds;
+}
@@ -0,0 +1,71 @@
+// Samples/second of the score sampler: the original per-call
+// std::normal_distribution path against the Philox sampler, scalar and
+// column-at-a-time.
+//
+//   clang++ -std=c++23 -O2 -march=native -I../src normal_sampler_bench.cpp
+#include <chrono>  // For timing
+#include <cstddef> // For size_t
+#include <cstdint> // For fixed-width seeds
+#include <print>   // C++23 printing
+#include <random>  // For the baseline engine
+#include <string_view> // For benchmark names
+#include <vector>      // For the output column
+
+#include "normal_sampler.hpp"
+#include "student.hpp"
+
+constexpr size_t NUM_SAMPLES = 1 << 24;
+constexpr std::uint64_t SEED = 20240501;
+constexpr NormalParams PARAMS{.mean = SCORE_MEAN_CENTER,
+                              .stddev = SCORE_STD_DEV};
+
+// Runs `fill` once and reports throughput; the checksum keeps the work alive.
+template <typename Fill>
+void run_benchmark(std::string_view name, std::vector<double> &column,
+                   Fill fill) {
+  const auto start = std::chrono::steady_clock::now();
+  fill(column);
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  double checksum = 0.0;
+  for (double value : column) {
+    checksum += value;
+  }
+  std::println("| {:<34} | {:>10.1f} | {:>12.3e} | {:>10.4f} |", name,
+               elapsed.count() * 1e3,
+               static_cast<double>(column.size()) / elapsed.count(),
+               checksum / static_cast<double>(column.size()));
+}
+
+auto main() -> int {
+  std::vector<double> column(NUM_SAMPLES);
+  std::println("Sampling {} normal scores (mean {}, stddev {})", NUM_SAMPLES,
+               PARAMS.mean, PARAMS.stddev);
+  std::println("| {:<34} | {:>10} | {:>12} | {:>10} |", "Sampler", "ms",
+               "samples/s", "mean");
+
+  run_benchmark("std::normal_distribution per call", column,
+                [](std::vector<double> &out) {
+                  std::mt19937 engine(SEED);
+                  for (double &value : out) {
+                    std::normal_distribution<double> dist(PARAMS.mean,
+                                                          PARAMS.stddev);
+                    value = dist(engine);
+                  }
+                });
+
+  run_benchmark("sample_normal (scalar Philox)", column,
+                [](std::vector<double> &out) {
+                  for (size_t i = 0; i < out.size(); ++i) {
+                    out[i] = sample_normal(PARAMS, SEED,
+                                           static_cast<std::uint32_t>(i), 0)
+                                 .value;
+                  }
+                });
+
+  run_benchmark("fill_normal_column (SIMD lanes)", column,
+                [](std::vector<double> &out) {
+                  fill_normal_column(out, {}, PARAMS, SEED, 0, 0);
+                });
+  return 0;
+}
@@ -0,0 +1,82 @@
+// Rows/second of a score-threshold filter: std::views::filter over the row
+// view, as make_filter_print_step used to run it, against the selection-vector
+// kernels behind StudentTable::positions_where; then, for a selective
+// threshold, the scan against listing the rows from the cached descending
+// order.
+//
+//   clang++ -std=c++23 -O2 -march=native -I../src score_filter_bench.cpp
+#include <cstddef>     // For size_t
+#include <print>       // C++23 printing
+#include <ranges>      // For the baseline filter view
+#include <string_view> // For benchmark names
+#include <utility>     // For std::pair
+
+#include "bench_common.hpp"
+#include "student.hpp"
+#include "student_table.hpp"
+
+constexpr size_t NUM_ROWS = 1 << 24;
+constexpr int REPEATS = 5;
+// About 0.4% of the bench scores lie above it
+constexpr double SELECTIVE_THRESHOLD = 150.0;
+
+// Reports the best of REPEATS passes of `filter`, with the rows it selected
+// and the checksum of their ids.
+template <typename Filter>
+void run_benchmark(std::string_view name, const StudentTable &table,
+                   Filter filter) {
+  const auto best = run_best_of(REPEATS, [&] {
+    long long checksum = 0;
+    const size_t selected = filter(table, checksum);
+    return std::pair{selected, checksum};
+  });
+  std::println("| {:<34} | {:>10.2f} | {:>12.3e} | {:>10} | {:>14} |", name,
+               best.seconds * 1e3, throughput(table.size(), best.seconds),
+               best.result.first, best.result.second);
+}
+
+auto main() -> int {
+  StudentTable table(NUM_ROWS, 1);
+  fill_bench_scores(table);
+  std::println("Filtering {} rows ({} scores) on score > {}", table.size(),
+               StudentTable::ScoreCodec::NAME, EXCELLENT_THRESHOLD);
+  std::println("| {:<34} | {:>10} | {:>12} | {:>10} | {:>14} |", "Filter",
+               "ms", "rows/s", "selected", "id checksum");
+
+  run_benchmark("views::filter over rows()", table,
+                [](const StudentTable &data, long long &checksum) {
+                  size_t count = 0;
+                  for (const Student &student :
+                       data.rows() | std::views::filter(
+                                         score_greater(EXCELLENT_THRESHOLD))) {
+                    checksum += student.id;
+                    count++;
+                  }
+                  return count;
+                });
+
+  run_benchmark("positions_where (selection vector)", table,
+                [](const StudentTable &data, long long &checksum) {
+                  const SelectionVector positions =
+                      data.positions_where(score_greater(EXCELLENT_THRESHOLD));
+                  for (const Student &student : data.rows(positions)) {
+                    checksum += student.id;
+                  }
+                  return positions.size();
+                });
+
+  const auto select_above = [](const StudentTable &data,
+                               long long &checksum) {
+    const SelectionVector positions =
+        data.positions_where(score_greater(SELECTIVE_THRESHOLD));
+    for (const Student &student : data.rows(positions)) {
+      checksum += student.id;
+    }
+    return positions.size();
+  };
+  std::println("\nOn score > {}", SELECTIVE_THRESHOLD);
+  run_benchmark("positions_where (scan)", table, select_above);
+  (void)table.descending_order(); // Cached from here on
+  run_benchmark("positions_where (cached order)", table, select_above);
+  return 0;
+}
@@ -0,0 +1,101 @@
+// Rows/second of the score-descending sort: std::ranges::sort over Student
+// rows, as the sort step used to run it, a comparison sort of a row
+// permutation on the stored scores, and the radix sort behind
+// StudentTable::sort_by_score_descending on one thread and on the pool.
+//
+//   clang++ -std=c++23 -O2 -march=native -I../src score_sort_bench.cpp
+#include <algorithm>   // For the comparison sorts
+#include <cstddef>     // For size_t
+#include <functional>  // For std::greater
+#include <numeric>     // For std::iota
+#include <print>       // C++23 printing
+#include <string_view> // For benchmark names
+#include <vector>      // For rows and permutations
+
+#include "bench_common.hpp"
+#include "score_sort.hpp"
+#include "student.hpp"
+#include "student_table.hpp"
+#include "task_pool.hpp"
+
+constexpr int REPEATS = 5;
+
+// Reports the best of REPEATS passes of `sort`, with the checksum of the
+// first rows it ordered.
+template <typename Sort>
+void run_benchmark(std::string_view name, const StudentTable &table,
+                   Sort sort) {
+  const auto best = run_best_of(REPEATS, [&] { return sort(table); });
+  std::println("| {:<30} | {:>10.3f} | {:>12.3e} | {:>12} |", name,
+               best.seconds * 1e3, throughput(table.size(), best.seconds),
+               best.result);
+}
+
+// Ids of the first few rows in `order`.
+auto head_checksum(const StudentTable &table,
+                   const std::vector<RowIndex> &order) -> long long {
+  long long checksum = 0;
+  for (size_t i = 0; i < std::min<size_t>(order.size(), 16); ++i) {
+    checksum = checksum * 31 + table.id_at(order[i]);
+  }
+  return checksum;
+}
+
+void run_size(size_t rows, TaskPool &serial, TaskPool &pool) {
+  StudentTable table(rows, 1);
+  fill_bench_scores(table);
+  std::println("\nSorting {} rows ({} scores), {} pool thread(s)",
+               table.size(), StudentTable::ScoreCodec::NAME,
+               pool.concurrency());
+  std::println("| {:<30} | {:>10} | {:>12} | {:>12} |", "Sort", "ms",
+               "rows/s", "checksum");
+
+  run_benchmark("ranges::sort of Student rows", table,
+                [](const StudentTable &data) {
+                  std::vector<Student> students;
+                  students.reserve(data.size());
+                  for (size_t row = 0; row < data.size(); ++row) {
+                    students.push_back(data[row]);
+                  }
+                  std::ranges::sort(students, std::greater<>{},
+                                    &Student::score);
+                  long long checksum = 0;
+                  const size_t head = std::min<size_t>(16, students.size());
+                  for (size_t i = 0; i < head; ++i) {
+                    checksum = checksum * 31 + students[i].id;
+                  }
+                  return checksum;
+                });
+
+  run_benchmark("ranges::sort of a permutation", table,
+                [](const StudentTable &data) {
+                  const auto column = data.stored_scores();
+                  std::vector<RowIndex> order(column.size());
+                  std::iota(order.begin(), order.end(), RowIndex{0});
+                  std::ranges::sort(order, std::greater<>{},
+                                    [column](RowIndex row) {
+                                      return column[row];
+                                    });
+                  return head_checksum(data, order);
+                });
+
+  run_benchmark("radix sort, 1 thread", table, [&](const StudentTable &data) {
+    return head_checksum(data,
+                         radix_sort_descending(data.stored_scores(), serial));
+  });
+
+  run_benchmark("radix sort, pool", table, [&](const StudentTable &data) {
+    return head_checksum(data,
+                         radix_sort_descending(data.stored_scores(), pool));
+  });
+}
+
+auto main() -> int {
+  TaskPool serial(TaskPoolOptions{.num_workers = 0});
+  TaskPool pool;
+  for (const size_t rows : {size_t{1} << 12, size_t{1} << 14, size_t{1} << 16,
+                            size_t{1} << 20, size_t{1} << 24}) {
+    run_size(rows, serial, pool);
+  }
+  return 0;
+}
@@ -0,0 +1,97 @@
+// Rows/second of rendering a student table: one std::println per row, as
+// print_student_table first did it, std::format_to into one buffer written
+// at the end, and append_student_row (std::to_chars) into one buffer.
+// Output goes to the null device, so only formatting and writing are timed.
+// The to_chars buffer is kept across repeats, which takes its growth out of
+// the timing: print_student_table allocates a fresh buffer per morsel, so
+// this is the cost of the rendering alone, not of a whole step.
+//
+//   clang++ -std=c++23 -O2 -march=native -I../src student_render_bench.cpp
+#include <cstddef>     // For size_t
+#include <cstdio>      // For the null device and std::fwrite
+#include <format>      // For the buffered baseline
+#include <iterator>    // For std::back_inserter
+#include <print>       // C++23 printing
+#include <string>      // For the output buffer
+#include <string_view> // For benchmark names
+#include <vector>      // For the rows
+
+#include "bench_common.hpp"
+#include "student.hpp"
+#include "student_render.hpp"
+
+constexpr size_t NUM_ROWS = 1 << 22;
+constexpr int REPEATS = 3;
+
+#if defined(_WIN32)
+constexpr const char *NULL_DEVICE = "NUL";
+#else
+constexpr const char *NULL_DEVICE = "/dev/null";
+#endif
+
+// Reports the best of REPEATS passes of `render`, with the bytes it wrote.
+template <typename Render>
+void run_benchmark(std::string_view name, const std::vector<Student> &rows,
+                   std::FILE *sink, Render render) {
+  const auto best = run_best_of(REPEATS, [&] {
+    const size_t bytes = render(rows, sink);
+    std::fflush(sink);
+    return bytes;
+  });
+  std::println("| {:<32} | {:>10.2f} | {:>12.3e} | {:>12} |", name,
+               best.seconds * 1e3, throughput(rows.size(), best.seconds),
+               best.result);
+}
+
+auto main() -> int {
+  std::vector<Student> rows(NUM_ROWS);
+  for (size_t row = 0; row < rows.size(); ++row) {
+    rows[row] = {.id = static_cast<int>(row) + 1, .score = bench_score(row)};
+  }
+  std::FILE *sink = std::fopen(NULL_DEVICE, "wb");
+  if (sink == nullptr) {
+    std::println("Cannot open {}", NULL_DEVICE);
+    return 1;
+  }
+  std::println("Rendering {} rows to {}", rows.size(), NULL_DEVICE);
+  std::println("| {:<32} | {:>10} | {:>12} | {:>12} |", "Renderer", "ms",
+               "rows/s", "bytes");
+
+  run_benchmark("std::println per row", rows, sink,
+                [](const std::vector<Student> &data, std::FILE *out) {
+                  for (const Student &student : data) {
+                    std::println(out, "| {:<{}} | {:<{}.2f} |", student.id,
+                                 RENDER_ID_WIDTH, student.score,
+                                 RENDER_SCORE_WIDTH);
+                  }
+                  return data.size() * RENDER_ROW_BYTES;
+                });
+
+  run_benchmark("std::format_to, one write", rows, sink,
+                [](const std::vector<Student> &data, std::FILE *out) {
+                  std::string text;
+                  for (const Student &student : data) {
+                    std::format_to(std::back_inserter(text),
+                                   "| {:<{}} | {:<{}.2f} |\n", student.id,
+                                   RENDER_ID_WIDTH, student.score,
+                                   RENDER_SCORE_WIDTH);
+                  }
+                  std::fwrite(text.data(), 1, text.size(), out);
+                  return text.size();
+                });
+
+  std::string buffer; // Kept across repeats; see the header comment
+  run_benchmark("append_student_row, one write", rows, sink,
+                [&buffer](const std::vector<Student> &data, std::FILE *out) {
+                  buffer.clear();
+                  buffer.reserve(data.size() * RENDER_ROW_BYTES);
+                  for (const Student &student : data) {
+                    append_student_row(buffer, student);
+                  }
+                  std::fwrite(buffer.data(), 1, buffer.size(), out);
+                  return buffer.size();
+                });
+
+  std::fclose(sink);
+  return 0;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <algorithm> // For std::max
+#include <atomic>    // For the ring indices and the queued byte count
+#include <bit>       // For std::bit_ceil
+#include <cstddef>   // For size_t
+#include <cstdio>    // For std::FILE, std::fwrite, std::fflush
+#include <string>    // For text blocks
+#include <thread>    // For std::jthread
+#include <utility>   // For std::move
+#include <vector>    // For the ring slots
+
+// --- AsyncWriter  ---
+// Writes text blocks to a FILE from a thread of its own, so a slow terminal
+// or pipe holds up only that thread. Blocks pass through a bounded
+// single-producer/single-consumer ring: the producer publishes a slot by
+// advancing `tail_`, the writer frees it by advancing `head_`, and neither
+// takes a lock. write() waits for the writer (backpressure) while the ring is
+// full or the new block would take the queued text past `max_bytes`, so the
+// writer holds at most `max_bytes` of text, or a single block that is larger
+// on its own. Blocks come out in the order they went in; the writer flushes
+// the FILE whenever it runs dry.
+//
+// One thread at a time may call write() and flush(). The destructor writes
+// out whatever is queued before it returns.
+constexpr size_t ASYNC_WRITER_MAX_BYTES = size_t{1} << 24;
+
+class AsyncWriter {
+public:
+  explicit AsyncWriter(std::FILE *out, size_t capacity = 16,
+                       size_t max_bytes = ASYNC_WRITER_MAX_BYTES)
+      : out_(out), slots_(std::bit_ceil(std::max<size_t>(capacity, 2))),
+        max_bytes_(max_bytes), writer_([this] { drain(); }) {}
+
+  AsyncWriter(const AsyncWriter &) = delete;
+  auto operator=(const AsyncWriter &) -> AsyncWriter & = delete;
+
+  ~AsyncWriter() {
+    push(std::string()); // An empty block tells the writer to stop
+  }
+
+  // Queues `block`, waiting while it does not fit. Empty blocks are dropped.
+  void write(std::string block) {
+    if (!block.empty()) {
+      push(std::move(block));
+    }
+  }
+
+  // Returns once every block queued so far has been written.
+  void flush() {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t head = head_.load(std::memory_order_acquire);
+    while (head != tail) {
+      head_.wait(head, std::memory_order_acquire);
+      head = head_.load(std::memory_order_acquire);
+    }
+  }
+
+private:
+  void push(std::string block) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t head = head_.load(std::memory_order_acquire);
+    while (tail - head == slots_.size() || !fits(block.size(), head, tail)) {
+      head_.wait(head, std::memory_order_acquire);
+      head = head_.load(std::memory_order_acquire);
+    }
+    queued_bytes_.fetch_add(block.size(), std::memory_order_relaxed);
+    slots_[tail & (slots_.size() - 1)] = std::move(block);
+    tail_.store(tail + 1, std::memory_order_release);
+    tail_.notify_one();
+  }
+
+  // Whether `bytes` more may join the blocks in [head, tail); an empty queue
+  // takes any block. The writer gives back a block's bytes before it
+  // advances `head_`, so the count read here is no older than `head`.
+  [[nodiscard]] auto fits(size_t bytes, size_t head, size_t tail) const
+      -> bool {
+    return head == tail ||
+           queued_bytes_.load(std::memory_order_relaxed) + bytes <= max_bytes_;
+  }
+
+  void drain() {
+    size_t head = head_.load(std::memory_order_relaxed);
+    while (true) {
+      const size_t tail = tail_.load(std::memory_order_acquire);
+      if (head == tail) {
+        std::fflush(out_);
+        tail_.wait(tail, std::memory_order_acquire);
+        continue;
+      }
+      const std::string block = std::move(slots_[head & (slots_.size() - 1)]);
+      if (block.empty()) {
+        std::fflush(out_);
+        return;
+      }
+      std::fwrite(block.data(), 1, block.size(), out_);
+      queued_bytes_.fetch_sub(block.size(), std::memory_order_relaxed);
+      head_.store(++head, std::memory_order_release);
+      head_.notify_all();
+    }
+  }
+
+  std::FILE *out_;
+  std::vector<std::string> slots_; // Size is a power of two
+  size_t max_bytes_;
+  std::atomic<size_t> queued_bytes_{0}; // In queued blocks not yet written
+  std::atomic<size_t> head_{0};         // Next slot the writer takes
+  std::atomic<size_t> tail_{0};         // Next slot the producer fills
+  std::jthread writer_;                 // Last: started once the rest exists
+};
@@ -1,270 +1,705 @@
-#include <algorithm>  // For std::ranges::sort, std::clamp
+#include <algorithm>  // For std::min, std::ranges::any_of
+#include <array>      // For the Pipeline's step handles
 #include <chrono>     // For seeding random generator
-#include <concepts>   // For defining range concepts
+#include <concepts>   // For std::same_as
 #include <cstddef>    // For size_t
-#include <expected>   // C++23 for error handling
+#include <cstdint>    // For the generation seed
+#include <filesystem> // For the export directory
 #include <format>     // For explicit formatting if needed
 #include <functional> // For std::function
-#include <numeric>    // For std::accumulate
+#include <iterator>   // For std::back_inserter
+#include <optional>   // For optional scan declarations
 #include <print>      // C++23 printing
-#include <random>     // For data generation
 #include <ranges>     // For views and range algorithms
 #include <span>       // C++20 for non-owning views of data
 #include <string>     // For error messages and string views
 #include <string_view> // For passing titles efficiently
-#include <thread>      // For sleep
-#include <utility>     // For std::move
+#include <tuple>       // For the steps of a Pipeline, std::apply
+#include <utility>     // For std::move, std::as_const, std::exchange
 #include <vector>      // For storing student data and processing steps
 
-// --- Structs, Concepts, Constants  ---
-struct Student {
-  int id;
-  double score;
-};
-template <typename R>
-concept StudentRange = std::ranges::input_range<R> &&
-                       std::same_as<std::ranges::range_value_t<R>, Student>;
-
-constexpr size_t NUM_STUDENTS = 30;
-constexpr double MAX_SCORE = 100.0;
-constexpr double MIN_SCORE = 0.0;
-constexpr double PASS_THRESHOLD = 60.0;
-constexpr double EXCELLENT_THRESHOLD = 85.0;
-constexpr double SCORE_MEAN_CENTER = 70.0;
-constexpr double SCORE_STD_DEV = 30.0;
-
-using SingleStudentResult = std::expected<Student, std::string>;
-
-// --- generate_single_student  ---
-auto generate_single_student(int student_id) -> SingleStudentResult {
-  static std::mt19937 engine(
-      std::chrono::system_clock::now().time_since_epoch().count());
-  std::normal_distribution<double> score_dist(SCORE_MEAN_CENTER, SCORE_STD_DEV);
-  std::uniform_int_distribution<int> error_injector(1, 20);
-  double generated_score = score_dist(engine);
-  bool injected_error = (error_injector(engine) == 1);
-
-  if (injected_error) {
-    return std::unexpected(
-        std::format("Generation failed: {}", "Simulated random error"));
+#include "async_writer.hpp"
+#include "parallel_scan.hpp"
+#include "score_reduce.hpp"
+#include "student.hpp"
+#include "student_export.hpp"
+#include "student_generator.hpp"
+#include "student_render.hpp"
+#include "student_table.hpp"
+#include "task_pool.hpp"
+
+// --- StepOutput  ---
+// Text produced by one step. Steps append to their own buffer rather than to
+// stdout, so steps running concurrently still print in pipeline order: the
+// scheduler hands each buffer to the AsyncWriter once every earlier step's
+// buffer has been handed over. The text is kept as a list of chunks (such as
+// the per-morsel texts of print_student_table, moved in whole), and the
+// writer takes them one at a time, so its byte bound applies to the chunks
+// rather than to a whole step.
+// It also carries the pool the step runs on, for steps that fan out work.
+class StepOutput {
+public:
+  explicit StepOutput(TaskPool &pool) : pool_(&pool) {}
+
+  template <typename... Args>
+  void println(std::format_string<Args...> fmt, Args &&...args) {
+    std::format_to(std::back_inserter(text_), fmt,
+                   std::forward<Args>(args)...);
+    text_.push_back('\n');
+  }
+  void append(std::string_view text) { text_.append(text); }
+  void append_row(const Student &student) {
+    append_student_row(text_, student);
+  }
+  // Adds `text` as a chunk of its own, after the text so far.
+  void append_chunk(std::string &&text) {
+    if (!text_.empty()) {
+      chunks_.push_back(std::exchange(text_, {}));
+    }
+    chunks_.push_back(std::move(text));
+  }
+
+  // The text so far in order, as chunks, leaving the output empty.
+  auto take_chunks() -> std::vector<std::string> {
+    if (!text_.empty()) {
+      chunks_.push_back(std::exchange(text_, {}));
+    }
+    return std::exchange(chunks_, {});
   }
-  if (generated_score < MIN_SCORE || generated_score > MAX_SCORE) {
-    return std::unexpected(std::format(
-        "Generation failed: Raw score {:.2f} out of range [{:.1f}, {:.1f}]",
-        generated_score, MIN_SCORE, MAX_SCORE));
+
+  [[nodiscard]] auto pool() const -> TaskPool & { return *pool_; }
+
+private:
+  std::vector<std::string> chunks_; // Finished chunks, before text_
+  std::string text_;
+  TaskPool *pool_;
+};
+
+// Hands everything `out` holds to `writer`, a chunk at a time, so the writer
+// can hold back a step with more text than it has room for.
+void write_step_output(StepOutput &out, AsyncWriter &writer) {
+  for (std::string &chunk : out.take_chunks()) {
+    writer.write(std::move(chunk));
   }
-  return Student{.id=student_id, .score=generated_score};
 }
 
 // --- print_student_table  ---
+constexpr size_t RENDER_MORSEL_ROWS = 16384; // Rows formatted per task
+
 void print_student_table(
-    std::string_view list_title,
+    StepOutput &out, std::string_view list_title,
     StudentRange auto &&student_range, // Accept any range of Students
     bool print_summary_count) {
-  constexpr int W_ID = 10;
-  constexpr int W_SCORE = 12;
+  constexpr int W_ID = RENDER_ID_WIDTH;
+  constexpr int W_SCORE = RENDER_SCORE_WIDTH;
   const size_t TABLE_WIDTH = W_ID + W_SCORE + 7;
 
-  std::println("--- {} ---", list_title); // Sub-header for the list
-  std::println("| {:<{}} | {:<{}} |", "Student ID", W_ID, "Score", W_SCORE);
-  std::println("|{}|{}|", std::string(W_ID + 2, '-'),
-               std::string(W_SCORE + 2, '-'));
+  out.println("--- {} ---", list_title); // Sub-header for the list
+  out.println("| {:<{}} | {:<{}} |", "Student ID", W_ID, "Score", W_SCORE);
+  out.println("|{}|{}|", std::string(W_ID + 2, '-'),
+              std::string(W_SCORE + 2, '-'));
 
   size_t count = 0;
 
-  for (const auto &student : student_range) {
-    std::println("| {:<{}} | {:<{}.2f} |", student.id, W_ID, student.score,
-                 W_SCORE);
-    count++;
+  using Range = decltype(std::as_const(student_range));
+  if constexpr (std::ranges::random_access_range<Range> &&
+                std::ranges::sized_range<Range>) {
+    // Rows by position (a table or a selection of it): format morsels of
+    // rows on the pool, each into its own buffer, and hand them over in order
+    // as chunks.
+    const auto &rows = std::as_const(student_range);
+    count = std::ranges::size(rows);
+    const size_t morsels =
+        (count + RENDER_MORSEL_ROWS - 1) / RENDER_MORSEL_ROWS;
+    std::vector<std::string> texts(morsels);
+    out.pool().parallel_for(morsels, [&](size_t morsel) {
+      const size_t begin = morsel * RENDER_MORSEL_ROWS;
+      const size_t end = std::min(begin + RENDER_MORSEL_ROWS, count);
+      texts[morsel].reserve((end - begin) * RENDER_ROW_BYTES);
+      for (size_t i = begin; i < end; ++i) {
+        append_student_row(
+            texts[morsel],
+            std::ranges::begin(rows)[static_cast<std::ptrdiff_t>(i)]);
+      }
+    });
+    for (std::string &text : texts) {
+      out.append_chunk(std::move(text));
+    }
+  } else {
+    for (const auto &student : student_range) {
+      out.append_row(student);
+      count++;
+    }
   }
 
-  std::println("{}", std::string(TABLE_WIDTH, '-'));
+  out.println("{}", std::string(TABLE_WIDTH, '-'));
   if (print_summary_count) {
-    std::println("Total matching students: {}", count);
+    out.println("Total matching students: {}", count);
     if (count == 0) {
-      std::println("(No students met the criteria for this list)");
+      out.println("(No students met the criteria for this list)");
     }
   }
-  std::println("");
+  out.println("");
 }
 
+// --- Access modes and scan declarations  ---
+// Whether a step may modify the table. Read-only steps between two mutating
+// steps run concurrently; a mutating step waits for everything before it and
+// runs alone.
+enum class AccessMode : std::uint8_t { ReadOnly, ReadWrite };
+
+// Column work a read-only step asks for up front. All the steps declaring it
+// between two mutating steps are served by one pass over the score column.
+// A step sets at most one of the two: a fixed threshold, or one derived from
+// the summary of all scores (an average, say), which the table maintains and
+// so is known before the pass.
+struct ScanNeeds {
+  std::optional<ScorePredicate> selection{}; // Rows the step lists
+  std::function<ScorePredicate(const ScoreSummary &)> selection_from_summary{};
+};
+
+// What that pass hands back to one step.
+struct ScanResult {
+  SelectionVector selection{}; // Empty unless the step asked for a selection
+  ScoreSummary summary{};      // The summary the selection was derived from
+};
+
 // --- ProcessingStep struct  ---
 struct ProcessingStep {
   std::string main_title;
-  std::function<void(std::vector<Student> &)>
+  std::function<void(StudentTable &, StepOutput &)>
       core_logic; // Can operate on mutable data
+  // Conservative default: assume the step writes.
+  AccessMode access = AccessMode::ReadWrite;
+  // Set only by read-only steps that declare their scan: the same logic, fed
+  // from a pass the scheduler may share with other steps.
+  std::optional<ScanNeeds> scan{};
+  std::function<void(const StudentTable &, ScanResult &&, StepOutput &)>
+      scanned_logic{};
+};
+
+// --- Scan helpers  ---
+// Shared by every way a scan step can run: alone, or fused with the other
+// scan steps of its phase.
+void add_scan_predicates(const ScanNeeds &needs, const ScoreSummary &summary,
+                         std::vector<ScorePredicate> &predicates) {
+  if (needs.selection) {
+    predicates.push_back(*needs.selection);
+  } else if (needs.selection_from_summary) {
+    predicates.push_back(needs.selection_from_summary(summary));
+  }
+}
+
+// Selections for `predicates` from one pass over the score column, or none
+// without a pass if there are no predicates.
+auto scan_selections(const StudentTable &data,
+                     std::span<const ScorePredicate> predicates,
+                     TaskPool &pool) -> std::vector<SelectionVector> {
+  if (predicates.empty()) {
+    return {};
+  }
+  return parallel_scan_scores(data, predicates, pool, false).selections;
+}
+
+// The share of `selections` that belongs to the step with `needs`, taken in
+// the order add_scan_predicates queued them.
+auto take_scan_result(const ScanNeeds &needs, const ScoreSummary &summary,
+                      std::vector<SelectionVector> &selections,
+                      size_t &next_selection) -> ScanResult {
+  ScanResult result{.summary = summary};
+  if (needs.selection || needs.selection_from_summary) {
+    result.selection = std::move(selections[next_selection++]);
+  }
+  return result;
+}
+
+// --- Concrete step types  ---
+// What the make_* factories return. A step keeps its logic as its own lambda
+// type, so a Pipeline of them calls each step directly and the predicates
+// inline into the loops that use them. Every step also converts to the
+// type-erased ProcessingStep, for pipelines assembled at run time.
+
+// A step that runs `core_logic` on the table.
+template <typename Logic> struct LogicStep {
+  std::string main_title;
+  Logic core_logic;
+  AccessMode access;
+
+  operator ProcessingStep() const {
+    return {.main_title = main_title,
+            .core_logic = core_logic,
+            .access = access};
+  }
+};
+
+// A read-only step that declares its scan.
+template <typename Logic> struct ScanStep {
+  static constexpr AccessMode access = AccessMode::ReadOnly;
+  std::string main_title;
+  ScanNeeds scan;
+  Logic scanned_logic;
+
+  // Run on its own, the step makes the pass itself.
+  void core_logic(StudentTable &data, StepOutput &out) const {
+    const StudentTable &const_data = data;
+    const ScoreSummary summary = const_data.score_summary();
+    std::vector<ScorePredicate> predicates;
+    add_scan_predicates(scan, summary, predicates);
+    std::vector<SelectionVector> selections =
+        scan_selections(const_data, predicates, out.pool());
+    size_t next_selection = 0;
+    scanned_logic(const_data,
+                  take_scan_result(scan, summary, selections, next_selection),
+                  out);
+  }
+
+  operator ProcessingStep() const {
+    return {.main_title = main_title,
+            .core_logic =
+                [step = *this](StudentTable &data, StepOutput &out) {
+                  step.core_logic(data, out);
+                },
+            .access = access,
+            .scan = scan,
+            .scanned_logic = scanned_logic};
+  }
+};
+
+// --- StepHandle  ---
+// Non-owning view of a step of any of the types above, as the scheduler sees
+// it. Calls go through plain function pointers into the step's own type.
+struct StepHandle {
+  std::string_view main_title;
+  AccessMode access;
+  const ScanNeeds *scan; // Null unless the step declares a scan
+  const void *step;
+  void (*run)(const void *step, StudentTable &data, StepOutput &out);
+  void (*run_scanned)(const void *step, const StudentTable &data,
+                      ScanResult &&result, StepOutput &out);
 };
 
+template <typename Step>
+auto make_step_handle(const Step &step) -> StepHandle {
+  StepHandle handle{
+      .main_title = step.main_title,
+      .access = step.access,
+      .scan = nullptr,
+      .step = &step,
+      .run =
+          [](const void *erased, StudentTable &data, StepOutput &out) {
+            static_cast<const Step *>(erased)->core_logic(data, out);
+          },
+      .run_scanned = nullptr};
+  if constexpr (requires { step.scanned_logic; }) {
+    if constexpr (std::same_as<Step, ProcessingStep>) {
+      handle.scan = step.scan ? &*step.scan : nullptr;
+    } else {
+      handle.scan = &step.scan;
+    }
+    handle.run_scanned = [](const void *erased, const StudentTable &data,
+                            ScanResult &&result, StepOutput &out) {
+      static_cast<const Step *>(erased)->scanned_logic(data, std::move(result),
+                                                       out);
+    };
+  }
+  return handle;
+}
+
 // --- execute_processing_step  ---
-void execute_processing_step(const ProcessingStep &step,
-                             std::vector<Student> &data) // Pass mutable data
-{
-  std::println("\n========== {} ==========", step.main_title);
+// Runs one step into `out`. A step with a precomputed `scan_result` is handed
+// it; any other step runs its own core logic.
+void execute_processing_step(const StepHandle &step,
+                             StudentTable &data, // Pass mutable data
+                             std::optional<ScanResult> &&scan_result,
+                             StepOutput &out) {
+  out.println("\n========== {} ==========", step.main_title);
   if (data.empty() && step.main_title != "(Hypothetical Static Step)") {
-    std::println("--- No student data available to process for this step ---");
-    std::println("");
+    out.println("--- No student data available to process for this step ---");
+    out.println("");
+    return;
+  }
+  if (scan_result) {
+    step.run_scanned(step.step, data, std::move(*scan_result), out);
     return;
   }
   // Execute the core logic, which now expects a mutable reference
-  step.core_logic(data);
+  step.run(step.step, data, out);
+}
+
+// --- run_steps  ---
+// The scheduler. Steps are split into phases at every mutating step: a
+// mutating step runs alone once everything before it is done, and the
+// read-only steps between two of them run concurrently, one pool task each.
+// All scan steps of a phase share a single StudentTable::scan_scores pass
+// made before the phase starts; a phase with no selection to make makes none.
+// Output reaches the AsyncWriter in step order.
+
+void run_read_only_phase(std::span<const StepHandle> phase,
+                         StudentTable &data, TaskPool &pool,
+                         AsyncWriter &writer) {
+  // Catch the maintained score summary up with earlier writes while the table
+  // is still ours alone, so the steps read it in O(1)
+  data.refresh_score_summary();
+  const bool has_scan_steps = std::ranges::any_of(
+      phase, [](const StepHandle &step) { return step.scan != nullptr; });
+  std::vector<std::optional<ScanResult>> scan_results(phase.size());
+  if (has_scan_steps && !data.empty()) {
+    const ScoreSummary summary = data.score_summary(); // O(1), refreshed
+    std::vector<ScorePredicate> predicates;
+    for (const auto &step : phase) {
+      if (step.scan) {
+        add_scan_predicates(*step.scan, summary, predicates);
+      }
+    }
+    std::vector<SelectionVector> selections =
+        scan_selections(std::as_const(data), predicates, pool);
+    size_t next_selection = 0;
+    for (size_t i = 0; i < phase.size(); ++i) {
+      if (phase[i].scan) {
+        scan_results[i] = take_scan_result(*phase[i].scan, summary,
+                                           selections, next_selection);
+      }
+    }
+  }
+
+  std::vector<StepOutput> outputs(phase.size(), StepOutput(pool));
+  std::vector<TaskGroup> step_done(phase.size()); // One group per step
+  for (size_t i = 0; i < phase.size(); ++i) {
+    pool.submit(step_done[i], [&, i] {
+      execute_processing_step(phase[i], data, std::move(scan_results[i]),
+                              outputs[i]);
+    });
+  }
+  for (size_t i = 0; i < phase.size(); ++i) {
+    pool.wait(step_done[i]); // Helps run the remaining steps meanwhile
+    write_step_output(outputs[i], writer);
+  }
+}
+
+void run_steps(std::span<const StepHandle> steps, StudentTable &data,
+               TaskPool &pool) {
+  // Step output goes out on the writer's thread while later steps run; the
+  // writer is drained before run_steps returns
+  AsyncWriter writer(stdout);
+  size_t next = 0;
+  while (next < steps.size()) {
+    if (steps[next].access == AccessMode::ReadWrite) {
+      StepOutput out(pool);
+      execute_processing_step(steps[next], data, std::nullopt, out);
+      write_step_output(out, writer);
+      next++;
+      continue;
+    }
+    size_t phase_end = next;
+    while (phase_end < steps.size() &&
+           steps[phase_end].access == AccessMode::ReadOnly) {
+      phase_end++;
+    }
+    run_read_only_phase(steps.subspan(next, phase_end - next), data, pool,
+                        writer);
+    next = phase_end;
+  }
+}
+
+// --- run_pipeline  ---
+// Runs a pipeline assembled at run time.
+void run_pipeline(std::span<const ProcessingStep> steps, StudentTable &data,
+                  TaskPool &pool = shared_task_pool()) {
+  std::vector<StepHandle> handles;
+  handles.reserve(steps.size());
+  for (const auto &step : steps) {
+    handles.push_back(make_step_handle(step));
+  }
+  run_steps(handles, data, pool);
 }
 
+// --- Pipeline  ---
+// A fixed list of concrete steps, held by value in a std::tuple. Scheduled
+// exactly like run_pipeline, but each step is reached through its own type
+// instead of a std::function.
+template <typename... Steps> class Pipeline {
+public:
+  explicit Pipeline(Steps... steps) : steps_(std::move(steps)...) {}
+
+  void run(StudentTable &data, TaskPool &pool = shared_task_pool()) const {
+    const std::array<StepHandle, sizeof...(Steps)> handles = std::apply(
+        [](const auto &...steps) {
+          return std::array<StepHandle, sizeof...(Steps)>{
+              make_step_handle(steps)...};
+        },
+        steps_);
+    run_steps(handles, data, pool);
+  }
+
+private:
+  std::tuple<Steps...> steps_;
+};
+
 // --- Factory Functions  ---
 
-// Filter & Print (Operates on const data indirectly via core_logic wrapper)
-template <typename FilterPredicate>
-auto make_filter_print_step(std::string&& main_title, std::string&& list_title,
-                       FilterPredicate filter, bool print_summary) -> ProcessingStep {
+// Scan Step (read-only; declares its column work so it can be fused)
+template <typename Logic>
+auto make_scan_step(std::string main_title, ScanNeeds needs, Logic logic)
+    -> ScanStep<Logic> {
   return {.main_title = std::move(main_title),
-          .core_logic = [=, filter = std::move(filter),
-                         list_title = std::move(list_title)](
-                            std::vector<Student> &data) {
-            std::span<const Student> view = data;
-            print_student_table(list_title, view | std::views::filter(filter),
-                                print_summary);
-          }};
+          .scan = needs,
+          .scanned_logic = std::move(logic)};
+}
+
+// Filter & Print (Read-only)
+template <typename FilterPredicate>
+auto make_filter_print_step(std::string &&main_title, std::string &&list_title,
+                            FilterPredicate filter, bool print_summary) {
+  auto core_logic = [=, filter = std::move(filter),
+                     list_title = std::move(list_title)](
+                        const StudentTable &data, StepOutput &out) {
+    print_student_table(out, list_title,
+                        data.rows() | std::views::filter(filter),
+                        print_summary);
+  };
+  return LogicStep<decltype(core_logic)>{.main_title = std::move(main_title),
+                                         .core_logic = std::move(core_logic),
+                                         .access = AccessMode::ReadOnly};
+}
+
+// Score-threshold Filter & Print: the table selects the matching rows on its
+// stored score encoding, and only those rows are decoded for printing.
+auto make_filter_print_step(std::string &&main_title, std::string &&list_title,
+                            ScorePredicate predicate, bool print_summary) {
+  return make_scan_step(
+      std::move(main_title), {.selection = predicate},
+      [=, list_title = std::move(list_title)](
+          const StudentTable &data, ScanResult &&result, StepOutput &out) {
+        print_student_table(out, list_title, data.rows(result.selection),
+                            print_summary);
+      });
 }
 
 // Action Step (Operates on mutable data)
-auto make_action_step(
-    std::string main_title,
-    std::function<void(std::vector<Student> &)> action // Expects mutable ref
-) -> ProcessingStep {
+template <typename Action> // Callable with StudentTable &, StepOutput &
+auto make_action_step(std::string main_title, Action action)
+    -> LogicStep<Action> {
   return {
       .main_title = std::move(main_title),
-      .core_logic = std::move(action) // Directly use the provided action
+      .core_logic = std::move(action), // Directly use the provided action
+      .access = AccessMode::ReadWrite};
+}
+
+// Custom Logic Step (Read-only: the logic only ever sees a const table)
+template <typename Logic> // Callable with const StudentTable &, StepOutput &
+auto make_custom_logic_step(std::string &&main_title, Logic logic) {
+  // Core logic lambda takes mutable ref but passes const ref internally
+  auto core_logic = [logic = std::move(logic)](StudentTable &data,
+                                               StepOutput &out) { // Mutable
+    const StudentTable &const_data = data; // Pass const
+    logic(const_data, out);
   };
+  return LogicStep<decltype(core_logic)>{.main_title = std::move(main_title),
+                                         .core_logic = std::move(core_logic),
+                                         .access = AccessMode::ReadOnly};
 }
 
-// Custom Logic Step (Operates on const data indirectly via core_logic wrapper)
-auto make_custom_logic_step(std::string&&main_title,
-                       std::function<void(const std::vector<Student> &)>
-                           logic // Logic itself takes const
-) -> ProcessingStep {
-  return {.main_title = std::move(main_title),
-          // Core logic lambda takes mutable ref but passes const ref internally
-          .core_logic = [logic = std::move(logic)](
-                            std::vector<Student> &data) {  // Takes mutable
-            const std::vector<Student> &const_data = data; // Pass const
-            logic(const_data);
-          }};
+// Statistics Step (Read-only): one morsel-parallel Welford pass over the
+// scores, then `logic` reports the merged ScoreStatistics
+template <typename Logic> // Callable with const StudentTable &,
+                          // const ScoreStatistics &, StepOutput &
+auto make_statistics_step(std::string &&main_title, Logic logic) {
+  return make_custom_logic_step(
+      std::move(main_title),
+      [logic = std::move(logic)](const StudentTable &data, StepOutput &out) {
+        logic(data, parallel_score_statistics(data, out.pool()), out);
+      });
+}
+
+// Top-K Step (Read-only): lists the `k` highest-scoring students, best first,
+// leaving the table as it is
+auto make_top_k_step(std::string &&main_title, size_t k) {
+  return make_custom_logic_step(
+      std::move(main_title), [k](const StudentTable &data, StepOutput &out) {
+        print_student_table(
+            out, std::format("List: Top {} Students by Score", k),
+            data.rows(data.top_positions(k, out.pool())), false);
+      });
+}
+
+// Export Step (Read-only): writes the students in descending score order to
+// `<directory>/<stem>.rows` and `<directory>/<stem>.cols` (see
+// student_export.hpp), then maps each file back to check its row count
+auto make_export_step(std::string &&main_title,
+                      std::filesystem::path directory, std::string stem) {
+  return make_custom_logic_step(
+      std::move(main_title),
+      [directory = std::move(directory),
+       stem = std::move(stem)](const StudentTable &data, StepOutput &out) {
+        const SelectionVector &order = data.descending_order(out.pool());
+        auto report = [&out](const std::filesystem::path &path,
+                             const std::expected<ExportReport, ExportError>
+                                 &written,
+                             const auto &read) {
+          if (!written) {
+            out.println("{}: {}", path.string(), written.error());
+          } else if (!read) {
+            out.println("{}: {}", path.string(), read.error());
+          } else {
+            out.println("Wrote {} rows ({} bytes) to {}, mapped back {} rows",
+                        written->rows, written->bytes, path.string(),
+                        read->size());
+          }
+        };
+        // Each file is written before it is opened again
+        const auto rows_path = directory / (stem + ".rows");
+        const auto rows_written = export_rows(rows_path, data, order);
+        report(rows_path, rows_written, RowExportView::open(rows_path));
+        const auto columns_path = directory / (stem + ".cols");
+        const auto columns_written =
+            export_columns(columns_path, data, order);
+        report(columns_path, columns_written,
+               ColumnExportView::open(columns_path));
+      });
 }
 
 // --- Main Program ---
-auto main() -> int {
-  std::vector<Student> students;
-  students.reserve(NUM_STUDENTS);
-  size_t current_id_index = 0;
+// Usage: program [export-directory]. With a directory, the sorted results are
+// also exported there in the binary row and column formats.
+auto main(int argc, char *argv[]) -> int {
+  const std::span<char *> args(argv, static_cast<size_t>(argc));
+  const auto seed = static_cast<std::uint64_t>(
+      std::chrono::system_clock::now().time_since_epoch().count());
+  StudentTable students(NUM_STUDENTS, 1);
+  // One pool runs everything: generation chunks and pipeline steps
+  TaskPool pool(TaskPoolOptions{.num_workers = default_worker_count() - 1,
+                                .pin_workers = false});
 
-  std::println("========== Generating Data for {} Students (Normal Dist., "
+  std::println("========== Generating Data for {} Students ({}, "
                "Retry on Error) ==========",
-               NUM_STUDENTS);
-  while (students.size() < NUM_STUDENTS) {
-    const int target_id = static_cast<int>(current_id_index + 1);
-    size_t attempt_count = 0;
-    std::print("  Generating data for ID {:<4}...", target_id);
-    while (true) {
-      attempt_count++;
-      SingleStudentResult result = generate_single_student(target_id);
-      if (result) {
-        students.push_back(result.value());
-        std::println(" [OK] Score: {:.2f} (Attempt {})", result.value().score,
-                     attempt_count);
-        current_id_index++;
-        break;
-      } else {
-        std::print("\n    [!!) Attempt {} Failed: {}. Retrying...",
-                   attempt_count, result.error());
-        std::this_thread::sleep_for(std::chrono::milliseconds(5));
-      }
-    }
+               NUM_STUDENTS, generation_mode_name(GENERATION_MODE));
+  std::println("  Seed: {}", seed);
+  const GenerationOptions options{
+      .seed = seed,
+      .retry_policy = make_jittered_backoff(std::chrono::milliseconds(1),
+                                            std::chrono::milliseconds(50),
+                                            32),
+      .pool = &pool};
+  const auto report = generate_students(students, 1, options);
+  if (!report) {
+    std::println("    [!!) {} under {} ({} attempts)", report.error(),
+                 options.retry_policy.name, options.retry_policy.max_attempts);
+    return 1;
   }
+  std::println("  {} attempts ({} retried, {} after backoff) across {} "
+               "worker(s), retry policy: {}",
+               report->total_attempts,
+               report->total_attempts - report->students_generated,
+               report->deferred_retries, report->workers_used,
+               options.retry_policy.name);
+  std::println("  Storage: {} bytes per student ({} scores, {} ids)",
+               students.bytes_per_row(), StudentTable::ScoreCodec::NAME,
+               students.has_implicit_ids() ? "implicit" : "stored");
   std::println("======= Generation Complete: {} Students Generated =======",
-               students.size());
+               report->students_generated);
 
   std::println("\n========== Processing Student Data ==========");
 
-  // --- Define Processing Steps using Vector Constructor and Factory Functions
-  // --- Initialize the vector directly using list initialization { }
-  const auto processing_steps = std::vector{
+  // --- Define Processing Steps as a compile-time Pipeline of the concrete
+  // --- step types the factories return
+  const auto processing_steps = Pipeline{
 
       // Step 1: Excellent Students (Filter & Print)
       make_filter_print_step(
           "(1) Filter: Excellent Students",
           std::format("List: Score > {:.1f}", EXCELLENT_THRESHOLD),
-          [](const Student &s) { return s.score > EXCELLENT_THRESHOLD; },
-          true), // Comma separates elements
+          score_greater(EXCELLENT_THRESHOLD), true), // Comma separates elements
 
       // Step 2: Failing Students (Filter & Print)
       make_filter_print_step(
           "(2) Filter: Failing Students",
           std::format("List: Score < {:.1f}", PASS_THRESHOLD),
-          [](const Student &s) { return s.score < PASS_THRESHOLD; }, true),
-
-      // Step 3: Calculate Average and Print Students Above Average (Custom
-      // Logic - FIXED)
-      make_custom_logic_step(
-          std::string{"(3) Calculate & Filter: Above Average"},
-          [](const std::vector<Student> &data) { // Logic lambda takes const ref
+          score_less(PASS_THRESHOLD), true),
+
+      // Step 3: Calculate Average and Print Students Above Average (Scan
+      // step: the threshold comes from the maintained summary, so the
+      // filter joins the phase's pass with (1) and (2))
+      make_scan_step(
+          "(3) Calculate & Filter: Above Average",
+          {.selection_from_summary =
+               [](const ScoreSummary &summary) {
+                 return score_at_least(summary.mean());
+               }},
+          [](const StudentTable &data, ScanResult &&result,
+             StepOutput &out) { // Logic lambda takes const ref
             if (data.empty()) { // Handle empty data case explicitly here too
-              std::println("--- Statistics ---");
-              std::println("Number of students analyzed: 0");
-              std::println("Calculated Average Score: N/A");
-              std::println("--------------------");
-              print_student_table("List: Scoring >= Average (N/A)",
+              out.println("--- Statistics ---");
+              out.println("Number of students analyzed: 0");
+              out.println("Calculated Average Score: N/A");
+              out.println("--------------------");
+              print_student_table(out, "List: Scoring >= Average (N/A)",
                                   std::span<const Student>{},
                                   true); // Pass empty span
               return;
             }
 
-            std::span<const Student> view = data;
+            // The average the selection was made against
+            const double average_score =
+                result.summary.mean(); // Empty data was handled above
 
-            // FIX 2: Use std::accumulate from <numeric> with iterators
-            double sum_of_scores =
-                std::accumulate(view.begin(), view.end(), 0.0,
-                                [](double current_sum, const Student &s) {
-                                  return current_sum + s.score;
-                                });
-
-            double average_score =
-                sum_of_scores /
-                view.size(); // Avoid division by zero checked above
-
-            std::println("--- Statistics ---");
-            std::println("Number of students analyzed: {}", view.size());
-            std::println("Calculated Average Score: {:.2f}", average_score);
-            std::println("--------------------");
+            out.println("--- Statistics ---");
+            out.println("Number of students analyzed: {}", data.size());
+            out.println("Calculated Average Score: {:.2f}", average_score);
+            out.println("--------------------");
 
             print_student_table(
+                out,
                 std::format("List: Scoring >= Average ({:.2f})", average_score),
-                view | std::views::filter([average_score](const Student &s) {
-                  return s.score >= average_score;
-                }),
-                true);
+                data.rows(result.selection), true);
+          }),
+
+      // Step 4: Score Distribution (Statistics)
+      make_statistics_step(
+          "(4) Statistics: Score Distribution",
+          [](const StudentTable &, const ScoreStatistics &statistics,
+             StepOutput &out) {
+            out.println("--- Statistics ---");
+            out.println("Number of students analyzed: {}", statistics.count);
+            out.println("Mean Score: {:.2f}", statistics.mean);
+            out.println("Variance: {:.2f}", statistics.variance());
+            out.println("Standard Deviation: {:.2f}", statistics.stddev());
+            out.println("Minimum Score: {:.2f}", statistics.min);
+            out.println("Maximum Score: {:.2f}", statistics.max);
+            out.println("--------------------");
+            out.println("");
           }),
 
-      // Step 4: Sort and Print All
-      make_action_step(
-          "(4) Action & View: Sort All and Print",
-          [](std::vector<Student> &data_to_sort_and_print) {
-            std::println("--- Sorting Data by Score (Descending)... ---");
-            // Using std::ranges::sort is correct here
-            std::ranges::sort(data_to_sort_and_print, std::greater<>{},
-                              &Student::score);
-            std::println("--- Data Sorted Successfully ---");
-            std::println(""); // Maintain spacing
+      // Step 5: Leaderboard (Top-K, no sort)
+      make_top_k_step("(5) View: Top Students", TOP_K_STUDENTS),
+
+      // Step 6: Sort and Print All (through the permutation index; the table
+      // stays in generation order)
+      make_custom_logic_step(
+          "(6) View: All Students Sorted by Score",
+          [](const StudentTable &data, StepOutput &out) {
+            out.println("--- Ordering Data by Score (Descending)... ---");
+            const SelectionVector &order = data.descending_order(out.pool());
+            out.println("--- Order Ready (Rows Left in Generation Order) ---");
+            out.println(""); // Maintain spacing
 
             print_student_table(
+                out,
                 "List: All Students (Sorted by Score Descending)", // List title
                                                                    // from
                                                                    // original
                                                                    // Step 5
-                data_to_sort_and_print, // Pass the now-sorted data
+                data.rows(order), // Rows in score order, by position
                 false);
           })};
-  // Execute the steps
-  for (const auto &step : processing_steps) {
-    execute_processing_step(step, students);
+  // Execute the steps: none of them modifies the table, so all six run
+  // concurrently and (1)-(3) share one pass over the scores
+  processing_steps.run(students, pool);
+
+  // Step 7: Export, after the steps above so its output follows theirs
+  if (args.size() > 1) {
+    Pipeline{make_export_step("(7) Export: Sorted Results", args[1],
+                              "students")}
+        .run(students, pool);
   }
 
   std::println("\n========== Processing Complete ==========");
@@ -0,0 +1,498 @@
+#pragma once
+
+#include <algorithm> // For std::clamp
+#include <bit>     // For std::bit_cast
+#include <cmath>   // For std::sqrt, std::erfc
+#include <cstddef> // For size_t
+#include <cstdint> // For fixed-width words
+#include <cstring> // For std::memcpy between lanes and memory
+#include <iterator> // For std::size
+#include <numbers> // For std::numbers::pi, std::numbers::sqrt2
+#include <span>    // C++20 for output columns
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h> // AVX2 / AVX-512 intrinsics
+#endif
+
+#include "philox.hpp"
+
+// Box-Muller normal sampler over Philox counters. Draw `index` of `stream` uses
+// the block with counter {index, stream, 0, 0}; word 0-1 feed the radius, word
+// 2 the angle, and word 3 is handed back untouched for the caller's own use.
+//
+// The math kernels are written once against a small set of lane operations and
+// instantiated for plain doubles, AVX2 (4 lanes) and AVX-512 (8 lanes), so a
+// column filled with SIMD holds exactly the values the scalar path returns.
+// Every multiply and add is a separate statement to keep clang from
+// contracting scalar code into FMAs the vector code does not use; GCC
+// contracts across statements unless built with -ffp-contract=off.
+
+struct NormalParams {
+  double mean;
+  double stddev;
+};
+
+struct NormalDraw {
+  double value;
+  std::uint32_t spare_word; // Philox word 3, free for the caller
+};
+
+namespace normal_sampler_detail {
+
+constexpr std::uint64_t EXPONENT_ONE = 0x3FF0000000000000ULL;
+constexpr std::uint64_t EXPONENT_HALF = 0x3FE0000000000000ULL;
+constexpr std::uint64_t MANTISSA_MASK = 0x000FFFFFFFFFFFFFULL;
+constexpr std::uint64_t LOW_WORD_MASK = 0xFFFFFFFFULL;
+constexpr std::uint64_t MAGIC_2P52 = 0x4330000000000000ULL; // bits of 2^52
+
+// --- Lane operations: scalar  ---
+inline auto broadcast_f(double value, double /*tag*/) -> double {
+  return value;
+}
+inline auto broadcast_u(std::uint64_t value, std::uint64_t /*tag*/)
+    -> std::uint64_t {
+  return value;
+}
+inline auto as_double(std::uint64_t bits) -> double {
+  return std::bit_cast<double>(bits);
+}
+inline auto as_bits(double value) -> std::uint64_t {
+  return std::bit_cast<std::uint64_t>(value);
+}
+inline auto shift_right(std::uint64_t bits, int count) -> std::uint64_t {
+  return bits >> static_cast<unsigned>(count);
+}
+inline auto shift_left(std::uint64_t bits, int count) -> std::uint64_t {
+  return bits << static_cast<unsigned>(count);
+}
+inline auto mul_32x32(std::uint64_t lane, std::uint32_t multiplier)
+    -> std::uint64_t {
+  return (lane & LOW_WORD_MASK) * multiplier;
+}
+inline auto square_root(double value) -> double { return std::sqrt(value); }
+inline auto abs_value(double value) -> double { return std::fabs(value); }
+inline auto select_less(double lhs, double rhs, double if_less,
+                        double otherwise) -> double {
+  return lhs < rhs ? if_less : otherwise;
+}
+
+#if defined(__AVX2__) && !defined(__AVX512F__)
+// --- Lane operations: AVX2  ---
+struct F64x4 {
+  __m256d v;
+  static constexpr size_t WIDTH = 4;
+};
+struct U64x4 {
+  __m256i v;
+};
+inline auto operator+(F64x4 a, F64x4 b) -> F64x4 {
+  return {_mm256_add_pd(a.v, b.v)};
+}
+inline auto operator-(F64x4 a, F64x4 b) -> F64x4 {
+  return {_mm256_sub_pd(a.v, b.v)};
+}
+inline auto operator*(F64x4 a, F64x4 b) -> F64x4 {
+  return {_mm256_mul_pd(a.v, b.v)};
+}
+inline auto operator/(F64x4 a, F64x4 b) -> F64x4 {
+  return {_mm256_div_pd(a.v, b.v)};
+}
+inline auto operator&(U64x4 a, U64x4 b) -> U64x4 {
+  return {_mm256_and_si256(a.v, b.v)};
+}
+inline auto operator|(U64x4 a, U64x4 b) -> U64x4 {
+  return {_mm256_or_si256(a.v, b.v)};
+}
+inline auto operator^(U64x4 a, U64x4 b) -> U64x4 {
+  return {_mm256_xor_si256(a.v, b.v)};
+}
+inline auto broadcast_f(double value, F64x4 /*tag*/) -> F64x4 {
+  return {_mm256_set1_pd(value)};
+}
+inline auto broadcast_u(std::uint64_t value, U64x4 /*tag*/) -> U64x4 {
+  return {_mm256_set1_epi64x(static_cast<long long>(value))};
+}
+inline auto as_double(U64x4 bits) -> F64x4 {
+  return {_mm256_castsi256_pd(bits.v)};
+}
+inline auto as_bits(F64x4 value) -> U64x4 {
+  return {_mm256_castpd_si256(value.v)};
+}
+inline auto shift_right(U64x4 bits, int count) -> U64x4 {
+  return {_mm256_srli_epi64(bits.v, count)};
+}
+inline auto shift_left(U64x4 bits, int count) -> U64x4 {
+  return {_mm256_slli_epi64(bits.v, count)};
+}
+inline auto mul_32x32(U64x4 lane, std::uint32_t multiplier) -> U64x4 {
+  return {_mm256_mul_epu32(lane.v, _mm256_set1_epi64x(multiplier))};
+}
+inline auto square_root(F64x4 value) -> F64x4 {
+  return {_mm256_sqrt_pd(value.v)};
+}
+inline auto abs_value(F64x4 value) -> F64x4 {
+  return {_mm256_andnot_pd(_mm256_set1_pd(-0.0), value.v)};
+}
+inline auto select_less(F64x4 lhs, F64x4 rhs, F64x4 if_less, F64x4 otherwise)
+    -> F64x4 {
+  return {_mm256_blendv_pd(otherwise.v, if_less.v,
+                           _mm256_cmp_pd(lhs.v, rhs.v, _CMP_LT_OQ))};
+}
+using VecF = F64x4;
+using VecU = U64x4;
+#define NORMAL_SAMPLER_HAS_SIMD 1
+#endif
+
+#if defined(__AVX512F__)
+// --- Lane operations: AVX-512  ---
+struct F64x8 {
+  __m512d v;
+  static constexpr size_t WIDTH = 8;
+};
+struct U64x8 {
+  __m512i v;
+};
+inline auto operator+(F64x8 a, F64x8 b) -> F64x8 {
+  return {_mm512_add_pd(a.v, b.v)};
+}
+inline auto operator-(F64x8 a, F64x8 b) -> F64x8 {
+  return {_mm512_sub_pd(a.v, b.v)};
+}
+inline auto operator*(F64x8 a, F64x8 b) -> F64x8 {
+  return {_mm512_mul_pd(a.v, b.v)};
+}
+inline auto operator/(F64x8 a, F64x8 b) -> F64x8 {
+  return {_mm512_div_pd(a.v, b.v)};
+}
+inline auto operator&(U64x8 a, U64x8 b) -> U64x8 {
+  return {_mm512_and_si512(a.v, b.v)};
+}
+inline auto operator|(U64x8 a, U64x8 b) -> U64x8 {
+  return {_mm512_or_si512(a.v, b.v)};
+}
+inline auto operator^(U64x8 a, U64x8 b) -> U64x8 {
+  return {_mm512_xor_si512(a.v, b.v)};
+}
+inline auto broadcast_f(double value, F64x8 /*tag*/) -> F64x8 {
+  return {_mm512_set1_pd(value)};
+}
+inline auto broadcast_u(std::uint64_t value, U64x8 /*tag*/) -> U64x8 {
+  return {_mm512_set1_epi64(static_cast<long long>(value))};
+}
+inline auto as_double(U64x8 bits) -> F64x8 {
+  return {_mm512_castsi512_pd(bits.v)};
+}
+inline auto as_bits(F64x8 value) -> U64x8 {
+  return {_mm512_castpd_si512(value.v)};
+}
+inline auto shift_right(U64x8 bits, int count) -> U64x8 {
+  return {_mm512_srli_epi64(bits.v, static_cast<unsigned>(count))};
+}
+inline auto shift_left(U64x8 bits, int count) -> U64x8 {
+  return {_mm512_slli_epi64(bits.v, static_cast<unsigned>(count))};
+}
+inline auto mul_32x32(U64x8 lane, std::uint32_t multiplier) -> U64x8 {
+  return {_mm512_mul_epu32(lane.v, _mm512_set1_epi64(multiplier))};
+}
+inline auto square_root(F64x8 value) -> F64x8 {
+  return {_mm512_sqrt_pd(value.v)};
+}
+inline auto abs_value(F64x8 value) -> F64x8 {
+  const __m512i sign_cleared =
+      _mm512_and_si512(_mm512_castpd_si512(value.v),
+                       _mm512_set1_epi64(0x7FFFFFFFFFFFFFFFLL));
+  return {_mm512_castsi512_pd(sign_cleared)};
+}
+inline auto select_less(F64x8 lhs, F64x8 rhs, F64x8 if_less, F64x8 otherwise)
+    -> F64x8 {
+  return {_mm512_mask_blend_pd(_mm512_cmp_pd_mask(lhs.v, rhs.v, _CMP_LT_OQ),
+                               otherwise.v, if_less.v)};
+}
+using VecF = F64x8;
+using VecU = U64x8;
+#define NORMAL_SAMPLER_HAS_SIMD 1
+#endif
+
+// --- Kernels (generic over lane type)  ---
+
+// Exact conversion of integers below 2^52 held in 64-bit lanes.
+template <typename F, typename U> auto small_int_to_double(U value) -> F {
+  const F shifted = as_double(value | broadcast_u(MAGIC_2P52, U{}));
+  return shifted - broadcast_f(0x1.0p52, F{});
+}
+
+// Natural log for arguments in [2^-52, 1]: split off the binary exponent,
+// then log(m) = 2 atanh((m - 1) / (m + 1)) with m in [sqrt(1/2), sqrt(2)),
+// where the atanh series converges to full precision in 12 terms.
+template <typename F, typename U> auto log_unit(F value) -> F {
+  constexpr int SERIES_TERMS = 12;
+  constexpr double LN2_HI = 0.693359375; // ln 2 = LN2_HI + LN2_LO
+  constexpr double LN2_LO = -2.121944400546905827679e-4;
+  const auto c = [](double constant) { return broadcast_f(constant, F{}); };
+
+  // value = mantissa * 2^exponent with mantissa in [0.5, 1)
+  const U bits = as_bits(value);
+  F exponent = small_int_to_double<F, U>(shift_right(bits, 52));
+  exponent = exponent - c(1022.0);
+  F mantissa = as_double((bits & broadcast_u(MANTISSA_MASK, U{})) |
+                         broadcast_u(EXPONENT_HALF, U{}));
+  const F sqrt_half = c(0.70710678118654752440);
+  exponent = select_less(mantissa, sqrt_half, exponent - c(1.0), exponent);
+  mantissa = select_less(mantissa, sqrt_half, mantissa + mantissa, mantissa);
+
+  const F s = (mantissa - c(1.0)) / (mantissa + c(1.0));
+  const F s2 = s * s;
+  F poly = c(1.0 / (2 * SERIES_TERMS - 1));
+  for (int k = SERIES_TERMS - 2; k > 0; --k) {
+    poly = poly * s2;
+    poly = poly + c(1.0 / (2 * k + 1));
+  }
+  poly = poly * s2;
+  F atanh = s * poly;
+  atanh = atanh + s;
+  const F exponent_lo = exponent * c(LN2_LO);
+  const F exponent_hi = exponent * c(LN2_HI);
+  F result = atanh + atanh;
+  result = result + exponent_lo;
+  return result + exponent_hi;
+}
+
+// cos(2*pi*u) for u in [0, 1): folded onto sin over [-pi/2, pi/2] and
+// evaluated with the Taylor series to x^19 (accurate to a few ulp).
+template <typename F> auto cos_two_pi(F unit) -> F {
+  constexpr double SIN_TERMS[] = {
+      -1.0 / 6.0,
+      1.0 / 120.0,
+      -1.0 / 5040.0,
+      1.0 / 362880.0,
+      -1.0 / 39916800.0,
+      1.0 / 6227020800.0,
+      -1.0 / 1307674368000.0,
+      1.0 / 355687428096000.0,
+      -1.0 / 121645100408832000.0};
+  const auto c = [](double constant) { return broadcast_f(constant, F{}); };
+
+  F folded = abs_value(unit - c(0.5));
+  folded = folded - c(0.25);
+  const F x = folded * c(6.283185307179586476925);
+  const F x2 = x * x;
+  F poly = c(SIN_TERMS[std::size(SIN_TERMS) - 1]);
+  for (size_t i = std::size(SIN_TERMS) - 1; i-- > 0;) {
+    poly = poly * x2;
+    poly = poly + c(SIN_TERMS[i]);
+  }
+  poly = poly * x2;
+  poly = poly * x;
+  return x + poly;
+}
+
+// Philox4x32-10 on per-lane counters {index, stream, 0, 0}; each 32-bit word
+// lives in the low half of a 64-bit lane.
+template <typename U> struct PhiloxLanes {
+  U word[4];
+};
+
+template <typename U>
+auto philox_lanes(U index, std::uint32_t stream, Philox4x32::Key key)
+    -> PhiloxLanes<U> {
+  const U low_mask = broadcast_u(LOW_WORD_MASK, U{});
+  U c0 = index;
+  U c1 = broadcast_u(stream, U{});
+  U c2 = broadcast_u(0, U{});
+  U c3 = broadcast_u(0, U{});
+  for (int round = 0; round < Philox4x32::ROUNDS; ++round) {
+    if (round > 0) {
+      key[0] += Philox4x32::WEYL_0;
+      key[1] += Philox4x32::WEYL_1;
+    }
+    const U prod0 = mul_32x32(c0, Philox4x32::MULTIPLIER_0);
+    const U prod1 = mul_32x32(c2, Philox4x32::MULTIPLIER_1);
+    c0 = shift_right(prod1, 32) ^ c1 ^ broadcast_u(key[0], U{});
+    c1 = prod1 & low_mask;
+    c2 = shift_right(prod0, 32) ^ c3 ^ broadcast_u(key[1], U{});
+    c3 = prod0 & low_mask;
+  }
+  return {{c0, c1, c2, c3}};
+}
+
+// 52-bit uniform in (0, 1] from words 0-1: 2 - [1, 2), so never exactly 0.
+template <typename F, typename U>
+auto unit_open_closed(const PhiloxLanes<U> &block) -> F {
+  const U mantissa =
+      shift_left(block.word[0], 20) ^ shift_right(block.word[1], 12);
+  const F one_to_two = as_double((mantissa & broadcast_u(MANTISSA_MASK, U{})) |
+                                 broadcast_u(EXPONENT_ONE, U{}));
+  return broadcast_f(2.0, F{}) - one_to_two;
+}
+
+// mean + stddev * sqrt(-2 ln u1) * cos(2 pi u2) for one Philox block.
+template <typename F, typename U>
+auto box_muller(const PhiloxLanes<U> &block, NormalParams params) -> F {
+  const auto c = [](double constant) { return broadcast_f(constant, F{}); };
+  const F u1 = unit_open_closed<F, U>(block);
+  F u2 = small_int_to_double<F, U>(block.word[2]);
+  u2 = u2 * c(0x1.0p-32);
+
+  F radius = log_unit<F, U>(u1) * c(-2.0);
+  radius = square_root(radius);
+  F value = radius * cos_two_pi(u2);
+  value = value * c(params.stddev);
+  return value + c(params.mean);
+}
+
+} // namespace normal_sampler_detail
+
+// --- sample_normal  ---
+// Scalar draw `index` of `stream`; the reference every SIMD lane matches.
+inline auto sample_normal(NormalParams params, std::uint64_t seed,
+                          std::uint32_t index, std::uint32_t stream)
+    -> NormalDraw {
+  using namespace normal_sampler_detail;
+  const auto block = philox_lanes<std::uint64_t>(
+      index, stream, Philox4x32::key_from_seed(seed));
+  return {.value = box_muller<double, std::uint64_t>(block, params),
+          .spare_word = static_cast<std::uint32_t>(block.word[3])};
+}
+
+// --- fill_normal_column  ---
+// values[i] = draw `first_index + i` of `stream`. When spare_words is not
+// empty it must be the same length as values and receives each draw's word 3.
+inline void fill_normal_column(std::span<double> values,
+                               std::span<std::uint32_t> spare_words,
+                               NormalParams params, std::uint64_t seed,
+                               std::uint32_t first_index,
+                               std::uint32_t stream) {
+  using namespace normal_sampler_detail;
+  size_t i = 0;
+#if defined(NORMAL_SAMPLER_HAS_SIMD)
+  constexpr size_t WIDTH = VecF::WIDTH;
+  const Philox4x32::Key key = Philox4x32::key_from_seed(seed);
+  alignas(64) std::uint64_t lane_index[WIDTH];
+  alignas(64) std::uint64_t lane_spare[WIDTH];
+  for (; i + WIDTH <= values.size(); i += WIDTH) {
+    for (size_t lane = 0; lane < WIDTH; ++lane) {
+      lane_index[lane] = static_cast<std::uint32_t>(first_index + i + lane);
+    }
+    VecU index{};
+    std::memcpy(&index.v, lane_index, sizeof(lane_index));
+    const auto block = philox_lanes<VecU>(index, stream, key);
+    const VecF value = box_muller<VecF, VecU>(block, params);
+    std::memcpy(values.data() + i, &value.v, sizeof(value.v));
+    if (!spare_words.empty()) {
+      std::memcpy(lane_spare, &block.word[3].v, sizeof(lane_spare));
+      for (size_t lane = 0; lane < WIDTH; ++lane) {
+        spare_words[i + lane] = static_cast<std::uint32_t>(lane_spare[lane]);
+      }
+    }
+  }
+#endif
+  for (; i < values.size(); ++i) {
+    const NormalDraw draw = sample_normal(
+        params, seed, first_index + static_cast<std::uint32_t>(i), stream);
+    values[i] = draw.value;
+    if (!spare_words.empty()) {
+      spare_words[i] = draw.spare_word;
+    }
+  }
+}
+
+// --- Truncated normal  ---
+// Normal restricted to [lower, upper], sampled exactly by inverting the CDF:
+// u in (0, 1] is mapped into [Phi(alpha), Phi(beta)] and pushed through
+// Phi^-1, so every draw lands in range without rejection.
+struct TruncatedNormalParams {
+  NormalParams base;
+  double lower;
+  double upper;
+  double cdf_lower; // Phi((lower - mean) / stddev)
+  double cdf_span;  // Phi((upper - mean) / stddev) - cdf_lower
+};
+
+inline auto standard_normal_cdf(double x) -> double {
+  return 0.5 * std::erfc(-x / std::numbers::sqrt2);
+}
+
+// Acklam's rational approximation (relative error 1.15e-9) polished with one
+// Halley step against erfc, which brings it to full double precision.
+inline auto standard_normal_quantile(double p) -> double {
+  constexpr double A[] = {-3.969683028665376e+01, 2.209460984245205e+02,
+                          -2.759285104469687e+02, 1.383577518672690e+02,
+                          -3.066479806614716e+01, 2.506628277459239e+00};
+  constexpr double B[] = {-5.447609879822406e+01, 1.615858368580409e+02,
+                          -1.556989798598866e+02, 6.680131188771972e+01,
+                          -1.328068155288572e+01};
+  constexpr double C[] = {-7.784894002430293e-03, -3.223964580411365e-01,
+                          -2.400758277161838e+00, -2.549732539343734e+00,
+                          4.374664141464968e+00,  2.938163982698783e+00};
+  constexpr double D[] = {7.784695709041462e-03, 3.224671290700398e-01,
+                          2.445134137142996e+00, 3.754408661907416e+00};
+  constexpr double P_LOW = 0.02425;
+
+  const auto tail = [&](double q) {
+    return (((((C[0] * q + C[1]) * q + C[2]) * q + C[3]) * q + C[4]) * q +
+            C[5]) /
+           ((((D[0] * q + D[1]) * q + D[2]) * q + D[3]) * q + 1.0);
+  };
+  double x = 0.0;
+  if (p < P_LOW) {
+    x = tail(std::sqrt(-2.0 * std::log(p)));
+  } else if (p > 1.0 - P_LOW) {
+    x = -tail(std::sqrt(-2.0 * std::log1p(-p)));
+  } else {
+    const double q = p - 0.5;
+    const double r = q * q;
+    x = (((((A[0] * r + A[1]) * r + A[2]) * r + A[3]) * r + A[4]) * r + A[5]) *
+        q /
+        (((((B[0] * r + B[1]) * r + B[2]) * r + B[3]) * r + B[4]) * r + 1.0);
+  }
+  const double error = standard_normal_cdf(x) - p;
+  const double step = error * std::sqrt(2.0 * std::numbers::pi) *
+                      std::exp(0.5 * x * x);
+  return x - step / (1.0 + 0.5 * x * step);
+}
+
+inline auto make_truncated_normal(NormalParams base, double lower,
+                                  double upper) -> TruncatedNormalParams {
+  const double cdf_lower =
+      standard_normal_cdf((lower - base.mean) / base.stddev);
+  const double cdf_upper =
+      standard_normal_cdf((upper - base.mean) / base.stddev);
+  return {.base = base,
+          .lower = lower,
+          .upper = upper,
+          .cdf_lower = cdf_lower,
+          .cdf_span = cdf_upper - cdf_lower};
+}
+
+// Truncated counterpart of sample_normal(): same counter, same spare word.
+inline auto sample_truncated_normal(const TruncatedNormalParams &params,
+                                    std::uint64_t seed, std::uint32_t index,
+                                    std::uint32_t stream) -> NormalDraw {
+  using namespace normal_sampler_detail;
+  const auto block = philox_lanes<std::uint64_t>(
+      index, stream, Philox4x32::key_from_seed(seed));
+  const double unit = unit_open_closed<double, std::uint64_t>(block);
+  const double z =
+      standard_normal_quantile(params.cdf_lower + unit * params.cdf_span);
+  // Guard the last ulp so rounding can never push a draw out of range
+  const double value = std::clamp(params.base.mean + params.base.stddev * z,
+                                  params.lower, params.upper);
+  return {.value = value,
+          .spare_word = static_cast<std::uint32_t>(block.word[3])};
+}
+
+inline void fill_truncated_normal_column(std::span<double> values,
+                                         std::span<std::uint32_t> spare_words,
+                                         const TruncatedNormalParams &params,
+                                         std::uint64_t seed,
+                                         std::uint32_t first_index,
+                                         std::uint32_t stream) {
+  for (size_t i = 0; i < values.size(); ++i) {
+    const NormalDraw draw = sample_truncated_normal(
+        params, seed, first_index + static_cast<std::uint32_t>(i), stream);
+    values[i] = draw.value;
+    if (!spare_words.empty()) {
+      spare_words[i] = draw.spare_word;
+    }
+  }
+}
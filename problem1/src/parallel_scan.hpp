@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm> // For std::min, std::ranges::copy
+#include <cstddef>   // For size_t
+#include <span>      // C++20 for predicate lists
+#include <utility>   // For std::move
+#include <vector>    // For per-morsel results
+
+#include "student.hpp"
+#include "student_table.hpp"
+#include "task_pool.hpp"
+
+// --- Morsel-parallel scans  ---
+// The score column is cut into fixed-size morsels, each scanned on the pool
+// by BasicStudentTable::scan_score_range, and the per-morsel results are
+// merged in morsel order. Morsel boundaries depend only on the row count, so
+// the result is the same for every pool size. Summaries are merged pairwise;
+// with floating-point codecs the sums can differ in the last bits from a
+// serial scan_scores. Without `summarize` only the selections are made and
+// the summary is left empty. As with scan_scores, selections the table can
+// list without a pass (BasicStudentTable::listed_positions_where) are left
+// out of it.
+constexpr size_t SCAN_MORSEL_ROWS = size_t{1} << 16;
+
+// The pass itself, with every predicate scanned.
+template <typename Codec>
+auto parallel_scan_pass(const BasicStudentTable<Codec> &table,
+                        std::span<const ScorePredicate> predicates,
+                        TaskPool &pool, bool summarize) -> ScoreScan {
+  const size_t morsels =
+      (table.size() + SCAN_MORSEL_ROWS - 1) / SCAN_MORSEL_ROWS;
+  if (morsels <= 1) {
+    auto scan = table.scan_score_range(predicates, 0, table.size(), summarize);
+    return {.selections = std::move(scan.selections),
+            .summary = scan.summary.decode()};
+  }
+
+  using PartialScan = typename BasicStudentTable<Codec>::PartialScoreScan;
+  std::vector<PartialScan> parts(morsels);
+  pool.parallel_for(morsels, [&](size_t morsel) {
+    const size_t begin = morsel * SCAN_MORSEL_ROWS;
+    parts[morsel] = table.scan_score_range(
+        predicates, begin, std::min(begin + SCAN_MORSEL_ROWS, table.size()),
+        summarize);
+  });
+
+  for (size_t stride = 1; stride < morsels; stride *= 2) {
+    for (size_t morsel = 0; morsel + stride < morsels; morsel += 2 * stride) {
+      parts[morsel].summary.merge(parts[morsel + stride].summary);
+    }
+  }
+  ScoreScan scan{.selections = std::vector<SelectionVector>(predicates.size()),
+                 .summary = parts.front().summary.decode()};
+
+  // Each morsel's positions go to their final offset; the copies of all
+  // predicates and morsels run as one batch of tasks.
+  std::vector<size_t> offsets(predicates.size() * morsels);
+  for (size_t i = 0; i < predicates.size(); ++i) {
+    size_t total = 0;
+    for (size_t morsel = 0; morsel < morsels; ++morsel) {
+      offsets[i * morsels + morsel] = total;
+      total += parts[morsel].selections[i].size();
+    }
+    scan.selections[i].resize(total);
+  }
+  pool.parallel_for(predicates.size() * morsels, [&](size_t task) {
+    const size_t i = task / morsels;
+    const size_t morsel = task % morsels;
+    std::ranges::copy(parts[morsel].selections[i],
+                      scan.selections[i].begin() +
+                          static_cast<std::ptrdiff_t>(offsets[task]));
+  });
+  return scan;
+}
+
+template <typename Codec>
+auto parallel_scan_scores(const BasicStudentTable<Codec> &table,
+                          std::span<const ScorePredicate> predicates,
+                          TaskPool &pool, bool summarize = true)
+    -> ScoreScan {
+  return table.scan_unlisted(
+      predicates, summarize, [&](std::span<const ScorePredicate> unlisted) {
+        return parallel_scan_pass(table, unlisted, pool, summarize);
+      });
+}
+
+// summarize_scores, morsel-parallel.
+template <typename Codec>
+auto parallel_summarize_scores(const BasicStudentTable<Codec> &table,
+                               TaskPool &pool) -> ScoreSummary {
+  return parallel_scan_scores(table, {}, pool).summary;
+}
+
+// score_statistics, morsel-parallel: each morsel gets its own Welford pass
+// and the results are merged pairwise in morsel order.
+template <typename Codec>
+auto parallel_score_statistics(const BasicStudentTable<Codec> &table,
+                               TaskPool &pool) -> ScoreStatistics {
+  const size_t morsels =
+      (table.size() + SCAN_MORSEL_ROWS - 1) / SCAN_MORSEL_ROWS;
+  if (morsels <= 1) {
+    return table.score_statistics();
+  }
+  std::vector<ScoreStatistics> parts(morsels);
+  pool.parallel_for(morsels, [&](size_t morsel) {
+    const size_t begin = morsel * SCAN_MORSEL_ROWS;
+    parts[morsel] = table.score_statistics(
+        begin, std::min(begin + SCAN_MORSEL_ROWS, table.size()));
+  });
+  for (size_t stride = 1; stride < morsels; stride *= 2) {
+    for (size_t morsel = 0; morsel + stride < morsels; morsel += 2 * stride) {
+      parts[morsel].merge(parts[morsel + stride]);
+    }
+  }
+  return parts.front();
+}
+
+// positions_where for a score threshold, morsel-parallel.
+template <typename Codec>
+auto parallel_positions_where(const BasicStudentTable<Codec> &table,
+                              ScorePredicate predicate, TaskPool &pool)
+    -> SelectionVector {
+  return std::move(
+      parallel_scan_scores(table, std::span(&predicate, 1), pool, false)
+          .selections.front());
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>   // For counter and key blocks
+#include <cstdint> // For fixed-width words
+
+// --- Philox4x32-10  ---
+// Counter-based generator from Salmon et al., "Parallel Random Numbers: As
+// Easy as 1, 2, 3" (SC'11). Output is a pure function of (counter, key): there
+// is no state to share between threads, and any block can be computed directly
+// without generating the ones before it.
+struct Philox4x32 {
+  using Counter = std::array<std::uint32_t, 4>;
+  using Key = std::array<std::uint32_t, 2>;
+
+  static constexpr int ROUNDS = 10;
+
+  static constexpr auto key_from_seed(std::uint64_t seed) -> Key {
+    return {static_cast<std::uint32_t>(seed),
+            static_cast<std::uint32_t>(seed >> 32U)};
+  }
+
+  static constexpr auto generate(Counter ctr, Key key) -> Counter {
+    for (int round = 0; round < ROUNDS; ++round) {
+      if (round > 0) {
+        key[0] += WEYL_0;
+        key[1] += WEYL_1;
+      }
+      const std::uint64_t prod0 = std::uint64_t{MULTIPLIER_0} * ctr[0];
+      const std::uint64_t prod1 = std::uint64_t{MULTIPLIER_1} * ctr[2];
+      ctr = {static_cast<std::uint32_t>(prod1 >> 32U) ^ ctr[1] ^ key[0],
+             static_cast<std::uint32_t>(prod1),
+             static_cast<std::uint32_t>(prod0 >> 32U) ^ ctr[3] ^ key[1],
+             static_cast<std::uint32_t>(prod0)};
+    }
+    return ctr;
+  }
+
+  static constexpr std::uint32_t MULTIPLIER_0 = 0xD2511F53U;
+  static constexpr std::uint32_t MULTIPLIER_1 = 0xCD9E8D57U;
+  static constexpr std::uint32_t WEYL_0 = 0x9E3779B9U;
+  static constexpr std::uint32_t WEYL_1 = 0xBB67AE85U;
+};
+
+// Known-answer vector from the Random123 distribution (kat_vectors).
+static_assert(Philox4x32::generate({0, 0, 0, 0}, {0, 0}) ==
+              Philox4x32::Counter{0x6627E8D5U, 0xE169C58DU, 0xBC57AC4CU,
+                                  0x9B00DBD8U});
+
+// --- Bounded integers  ---
+// Unbiased-enough bounded integer in [0, bound) via multiply-shift.
+constexpr auto philox_below(std::uint32_t word, std::uint32_t bound)
+    -> std::uint32_t {
+  return static_cast<std::uint32_t>((std::uint64_t{word} * bound) >> 32U);
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <algorithm>  // For std::min
+#include <chrono>     // For backoff durations
+#include <cstdint>    // For attempt counters and jitter words
+#include <functional> // For std::function
+#include <limits>     // For the unlimited attempt budget
+#include <optional>   // For the give-up decision
+#include <string>     // For policy names
+#include <utility>    // For std::move
+
+// --- RetryPolicy  ---
+// Strategy consulted after every failed attempt. `backoff` maps the number of
+// attempts made so far (1 after the first failure) and a uniformly random
+// 32-bit jitter word to the delay before the next attempt; a zero delay means
+// retry immediately. Once `max_attempts` attempts have failed the generator
+// gives up on that student.
+struct RetryPolicy {
+  std::string name;
+  std::uint32_t max_attempts;
+  std::function<std::chrono::nanoseconds(std::uint32_t attempts_made,
+                                         std::uint32_t jitter_word)>
+      backoff;
+};
+
+constexpr std::uint32_t UNLIMITED_ATTEMPTS =
+    std::numeric_limits<std::uint32_t>::max();
+
+// Delay before the next attempt, or std::nullopt when the budget is spent.
+inline auto next_retry_delay(const RetryPolicy &policy,
+                             std::uint32_t attempts_made,
+                             std::uint32_t jitter_word)
+    -> std::optional<std::chrono::nanoseconds> {
+  if (attempts_made >= policy.max_attempts) {
+    return std::nullopt;
+  }
+  return policy.backoff(attempts_made, jitter_word);
+}
+
+// --- Factory Functions  ---
+
+// Retry at once, up to `max_attempts` attempts in total.
+inline auto
+make_immediate_retry(std::uint32_t max_attempts = UNLIMITED_ATTEMPTS)
+    -> RetryPolicy {
+  return {.name = "immediate",
+          .max_attempts = max_attempts,
+          .backoff = [](std::uint32_t, std::uint32_t) {
+            return std::chrono::nanoseconds::zero();
+          }};
+}
+
+// base * 2^(attempts_made - 1), capped at `cap`.
+inline auto make_exponential_backoff(std::chrono::nanoseconds base,
+                                     std::chrono::nanoseconds cap,
+                                     std::uint32_t max_attempts)
+    -> RetryPolicy {
+  return {.name = "exponential backoff",
+          .max_attempts = max_attempts,
+          .backoff = [base, cap](std::uint32_t attempts_made, std::uint32_t) {
+            const std::uint32_t doublings = std::min(attempts_made - 1, 30U);
+            return std::min(cap, base * (std::int64_t{1} << doublings));
+          }};
+}
+
+// "Full jitter": uniform in [0, exponential delay], which spreads retries of
+// many failures that happened together instead of waking them in lockstep.
+inline auto make_jittered_backoff(std::chrono::nanoseconds base,
+                                  std::chrono::nanoseconds cap,
+                                  std::uint32_t max_attempts) -> RetryPolicy {
+  RetryPolicy policy = make_exponential_backoff(base, cap, max_attempts);
+  policy.name = "jittered exponential backoff";
+  policy.backoff = [exponential = std::move(policy.backoff)](
+                       std::uint32_t attempts_made, std::uint32_t jitter_word) {
+    const std::chrono::nanoseconds ceiling =
+        exponential(attempts_made, jitter_word);
+    return std::chrono::nanoseconds{static_cast<std::int64_t>(
+        static_cast<double>(ceiling.count()) * jitter_word * 0x1.0p-32)};
+  };
+  return policy;
+}
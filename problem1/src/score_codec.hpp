@@ -0,0 +1,132 @@
+#pragma once
+
+#include <algorithm> // For std::clamp
+#include <cmath>     // For std::floor, std::lround, std::nextafter
+#include <cstdint>   // For the fixed-point storage type
+#include <limits>    // For infinities
+#include <string_view> // For codec names
+#include <type_traits> // For std::conditional_t, std::is_same_v
+
+// --- Score Codecs  ---
+// How a StudentTable stores its score column. Each codec maps a score to a
+// stored value and back, monotonically, and translates a score threshold into
+// the stored domain so filters can compare stored values without decoding:
+//   score >  x  <=>  stored >  floor_cutoff(x)
+//   score <= x  <=>  stored <= floor_cutoff(x)
+//   score <  x  <=>  stored <  ceil_cutoff(x)
+//   score >= x  <=>  stored >= ceil_cutoff(x)
+// where "score" is the decoded value the rest of the program sees. Sums (and
+// sums of squares) run in `Accumulator` and are decoded once at the end.
+
+// Full double precision, 8 bytes per score.
+struct Float64ScoreCodec {
+  using Stored = double;
+  using Cutoff = double;
+  static constexpr std::string_view NAME = "float64";
+
+  static constexpr auto encode(double score) -> Stored { return score; }
+  static constexpr auto decode(Stored stored) -> double { return stored; }
+  static constexpr auto floor_cutoff(double x) -> Cutoff { return x; }
+  static constexpr auto ceil_cutoff(double x) -> Cutoff { return x; }
+  using Accumulator = double;
+  static constexpr auto sum_to_score(Accumulator sum) -> double { return sum; }
+  static constexpr auto sum_of_squares_to_score(Accumulator sum) -> double {
+    return sum;
+  }
+};
+
+// Single precision, 4 bytes per score (about 7 significant digits).
+struct Float32ScoreCodec {
+  using Stored = float;
+  using Cutoff = float;
+  static constexpr std::string_view NAME = "float32";
+
+  static auto encode(double score) -> Stored {
+    return static_cast<float>(score);
+  }
+  static constexpr auto decode(Stored stored) -> double { return stored; }
+  // Largest float <= x, smallest float >= x.
+  static auto floor_cutoff(double x) -> Cutoff {
+    const auto rounded = static_cast<float>(x);
+    return static_cast<double>(rounded) > x ? std::nextafter(rounded, -INF)
+                                            : rounded;
+  }
+  static auto ceil_cutoff(double x) -> Cutoff {
+    const auto rounded = static_cast<float>(x);
+    return static_cast<double>(rounded) < x ? std::nextafter(rounded, INF)
+                                            : rounded;
+  }
+  using Accumulator = double;
+  static constexpr auto sum_to_score(Accumulator sum) -> double { return sum; }
+  static constexpr auto sum_of_squares_to_score(Accumulator sum) -> double {
+    return sum;
+  }
+
+private:
+  static constexpr float INF = std::numeric_limits<float>::infinity();
+};
+
+// Hundredths of a point in a uint16_t, 2 bytes per score. Scores are printed
+// with two decimals, so this loses nothing visible; sums are exact integers.
+struct FixedPoint16ScoreCodec {
+  using Stored = std::uint16_t;
+  using Cutoff = std::int32_t; // Wide enough for "below 0" and "above max"
+  static constexpr std::string_view NAME = "fixed-point uint16 (x100)";
+  static constexpr double SCALE = 100.0;
+
+  static auto encode(double score) -> Stored {
+    return static_cast<Stored>(std::clamp(
+        std::lround(score * SCALE), 0L,
+        static_cast<long>(std::numeric_limits<Stored>::max())));
+  }
+  static constexpr auto decode(Stored stored) -> double {
+    return stored / SCALE;
+  }
+  // Largest stored value whose decoded score is <= x (may be -1).
+  static auto floor_cutoff(double x) -> Cutoff {
+    const double bounded = std::clamp(x, -1.0, MAX_DECODED + 1.0);
+    auto cutoff = static_cast<Cutoff>(std::floor(bounded * SCALE));
+    while (cutoff + 1 <= MAX_STORED && (cutoff + 1) / SCALE <= x) {
+      cutoff++;
+    }
+    while (cutoff >= 0 && cutoff / SCALE > x) {
+      cutoff--;
+    }
+    return std::clamp(cutoff, Cutoff{-1}, MAX_STORED);
+  }
+  // Smallest stored value whose decoded score is >= x (may be max + 1).
+  static auto ceil_cutoff(double x) -> Cutoff {
+    return floor_cutoff(x) + 1 - (decodes_to(floor_cutoff(x), x) ? 1 : 0);
+  }
+  using Accumulator = std::uint64_t;
+  static constexpr auto sum_to_score(Accumulator sum) -> double {
+    return static_cast<double>(sum) / SCALE;
+  }
+  static constexpr auto sum_of_squares_to_score(Accumulator sum) -> double {
+    return static_cast<double>(sum) / (SCALE * SCALE);
+  }
+
+private:
+  static constexpr Cutoff MAX_STORED = std::numeric_limits<Stored>::max();
+  static constexpr double MAX_DECODED = MAX_STORED / SCALE;
+  static auto decodes_to(Cutoff stored, double x) -> bool {
+    return stored >= 0 && stored / SCALE == x;
+  }
+};
+
+// --- Score storage switch  ---
+enum class ScoreStorage : std::uint8_t { Float64, Float32, FixedPoint16 };
+constexpr ScoreStorage SCORE_STORAGE = ScoreStorage::Float64;
+
+template <ScoreStorage Storage>
+using ScoreCodecFor = std::conditional_t<
+    Storage == ScoreStorage::Float64, Float64ScoreCodec,
+    std::conditional_t<Storage == ScoreStorage::Float32, Float32ScoreCodec,
+                       FixedPoint16ScoreCodec>>;
+
+// The ScoreStorage value whose ScoreCodecFor is `Codec`.
+template <typename Codec>
+constexpr ScoreStorage SCORE_STORAGE_OF =
+    std::is_same_v<Codec, Float64ScoreCodec>   ? ScoreStorage::Float64
+    : std::is_same_v<Codec, Float32ScoreCodec> ? ScoreStorage::Float32
+                                               : ScoreStorage::FixedPoint16;
@@ -0,0 +1,278 @@
+#pragma once
+
+#include <array>   // For the AVX2 compress table
+#include <bit>     // For std::popcount
+#include <cstddef> // For size_t
+#include <cstdint> // For RowIndex and stored score types
+#include <span>    // C++20 for score columns
+#include <vector>  // For selection vectors
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h> // AVX2 / AVX-512 intrinsics
+#endif
+
+#include "student.hpp"
+
+// Row positions are 32-bit: half the size of size_t in selection vectors and
+// permutations, and far more rows than a table holds in practice.
+using RowIndex = std::uint32_t;
+using SelectionVector = std::vector<RowIndex>;
+
+// Threshold filters over a score column in its stored encoding (double, float
+// or uint16_t against an int32_t cutoff). One pass, no data-dependent
+// branches: each block of lanes is compared at once into a bit mask, and the
+// positions of the set bits are written out with a compress store (AVX-512)
+// or a lookup of the set-bit offsets (AVX2). The scalar path and the tail
+// write every position and advance the output by the comparison result.
+
+namespace score_filter_detail {
+
+template <ScoreComparison Comparison, typename Stored, typename Cutoff>
+auto compare(Stored value, Cutoff cutoff) -> bool {
+  const auto lhs = static_cast<Cutoff>(value);
+  if constexpr (Comparison == ScoreComparison::Greater) {
+    return lhs > cutoff;
+  } else if constexpr (Comparison == ScoreComparison::GreaterEqual) {
+    return lhs >= cutoff;
+  } else if constexpr (Comparison == ScoreComparison::Less) {
+    return lhs < cutoff;
+  } else {
+    return lhs <= cutoff;
+  }
+}
+
+#if defined(__AVX512F__)
+// --- Block masks: AVX-512 (16 rows)  ---
+constexpr size_t SELECT_LANES = 16;
+
+template <ScoreComparison Comparison> constexpr int float_predicate() {
+  if constexpr (Comparison == ScoreComparison::Greater) {
+    return _CMP_GT_OQ;
+  } else if constexpr (Comparison == ScoreComparison::GreaterEqual) {
+    return _CMP_GE_OQ;
+  } else if constexpr (Comparison == ScoreComparison::Less) {
+    return _CMP_LT_OQ;
+  } else {
+    return _CMP_LE_OQ;
+  }
+}
+
+template <ScoreComparison Comparison> constexpr int int_predicate() {
+  if constexpr (Comparison == ScoreComparison::Greater) {
+    return _MM_CMPINT_NLE;
+  } else if constexpr (Comparison == ScoreComparison::GreaterEqual) {
+    return _MM_CMPINT_NLT;
+  } else if constexpr (Comparison == ScoreComparison::Less) {
+    return _MM_CMPINT_LT;
+  } else {
+    return _MM_CMPINT_LE;
+  }
+}
+
+template <ScoreComparison Comparison>
+auto block_mask(const double *values, double cutoff) -> std::uint32_t {
+  const __m512d bound = _mm512_set1_pd(cutoff);
+  const __mmask8 low = _mm512_cmp_pd_mask(_mm512_loadu_pd(values), bound,
+                                          float_predicate<Comparison>());
+  const __mmask8 high = _mm512_cmp_pd_mask(_mm512_loadu_pd(values + 8), bound,
+                                           float_predicate<Comparison>());
+  return static_cast<std::uint32_t>(low) |
+         (static_cast<std::uint32_t>(high) << 8U);
+}
+
+template <ScoreComparison Comparison>
+auto block_mask(const float *values, float cutoff) -> std::uint32_t {
+  return _mm512_cmp_ps_mask(_mm512_loadu_ps(values), _mm512_set1_ps(cutoff),
+                            float_predicate<Comparison>());
+}
+
+template <ScoreComparison Comparison>
+auto block_mask(const std::uint16_t *values, std::int32_t cutoff)
+    -> std::uint32_t {
+  const __m512i widened = _mm512_cvtepu16_epi32(
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values)));
+  return _mm512_cmp_epi32_mask(widened, _mm512_set1_epi32(cutoff),
+                               int_predicate<Comparison>());
+}
+
+// Writes the positions `first_row + i` for the set bits i of `mask`.
+inline auto emit_positions(RowIndex *out, RowIndex first_row,
+                           std::uint32_t mask) -> size_t {
+  const __m512i positions =
+      _mm512_add_epi32(_mm512_set1_epi32(static_cast<int>(first_row)),
+                       _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+                                         12, 13, 14, 15));
+  _mm512_mask_compressstoreu_epi32(out, static_cast<__mmask16>(mask),
+                                   positions);
+  return static_cast<size_t>(std::popcount(mask));
+}
+#define SCORE_FILTER_HAS_SIMD 1
+
+#elif defined(__AVX2__)
+// --- Block masks: AVX2 (8 rows)  ---
+constexpr size_t SELECT_LANES = 8;
+
+template <ScoreComparison Comparison> constexpr int float_predicate() {
+  if constexpr (Comparison == ScoreComparison::Greater) {
+    return _CMP_GT_OQ;
+  } else if constexpr (Comparison == ScoreComparison::GreaterEqual) {
+    return _CMP_GE_OQ;
+  } else if constexpr (Comparison == ScoreComparison::Less) {
+    return _CMP_LT_OQ;
+  } else {
+    return _CMP_LE_OQ;
+  }
+}
+
+template <ScoreComparison Comparison>
+auto block_mask(const double *values, double cutoff) -> std::uint32_t {
+  const __m256d bound = _mm256_set1_pd(cutoff);
+  const int low = _mm256_movemask_pd(_mm256_cmp_pd(
+      _mm256_loadu_pd(values), bound, float_predicate<Comparison>()));
+  const int high = _mm256_movemask_pd(_mm256_cmp_pd(
+      _mm256_loadu_pd(values + 4), bound, float_predicate<Comparison>()));
+  return static_cast<std::uint32_t>(low | (high << 4));
+}
+
+template <ScoreComparison Comparison>
+auto block_mask(const float *values, float cutoff) -> std::uint32_t {
+  return static_cast<std::uint32_t>(_mm256_movemask_ps(
+      _mm256_cmp_ps(_mm256_loadu_ps(values), _mm256_set1_ps(cutoff),
+                    float_predicate<Comparison>())));
+}
+
+// AVX2 only has a signed "greater than" for integers; the other three
+// comparisons swap its operands and/or invert the result.
+template <ScoreComparison Comparison>
+auto block_mask(const std::uint16_t *values, std::int32_t cutoff)
+    -> std::uint32_t {
+  const __m256i widened = _mm256_cvtepu16_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(values)));
+  const __m256i bound = _mm256_set1_epi32(cutoff);
+  constexpr bool SWAPPED = Comparison == ScoreComparison::Less ||
+                           Comparison == ScoreComparison::GreaterEqual;
+  constexpr bool INVERTED = Comparison == ScoreComparison::LessEqual ||
+                            Comparison == ScoreComparison::GreaterEqual;
+  const __m256i greater = SWAPPED ? _mm256_cmpgt_epi32(bound, widened)
+                                  : _mm256_cmpgt_epi32(widened, bound);
+  const auto mask = static_cast<std::uint32_t>(
+      _mm256_movemask_ps(_mm256_castsi256_ps(greater)));
+  return INVERTED ? mask ^ 0xFFU : mask;
+}
+
+// Offsets of the set bits of every 8-bit mask, packed to the front.
+inline constexpr auto COMPRESS_TABLE = [] {
+  std::array<std::array<std::uint32_t, 8>, 256> table{};
+  for (std::uint32_t mask = 0; mask < 256; ++mask) {
+    std::uint32_t next = 0;
+    for (std::uint32_t bit = 0; bit < 8; ++bit) {
+      if ((mask >> bit) & 1U) {
+        table[mask][next++] = bit;
+      }
+    }
+  }
+  return table;
+}();
+
+// Writes the positions `first_row + i` for the set bits i of `mask`. Always
+// stores 8 lanes; the caller leaves room past the end.
+inline auto emit_positions(RowIndex *out, RowIndex first_row,
+                           std::uint32_t mask) -> size_t {
+  const __m256i offsets = _mm256_loadu_si256(
+      reinterpret_cast<const __m256i *>(COMPRESS_TABLE[mask].data()));
+  _mm256_storeu_si256(
+      reinterpret_cast<__m256i *>(out),
+      _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(first_row)),
+                       offsets));
+  return static_cast<size_t>(std::popcount(mask));
+}
+#define SCORE_FILTER_HAS_SIMD 1
+
+#else
+constexpr size_t SELECT_LANES = 1;
+#endif
+
+// Appends the positions `first_row + row` of the matching rows of `column`.
+template <ScoreComparison Comparison, typename Stored, typename Cutoff>
+void append_selected(std::span<const Stored> column, RowIndex first_row,
+                     Cutoff cutoff, SelectionVector &positions) {
+  // Room for a full block store past the last selected row.
+  const size_t start = positions.size();
+  positions.resize(start + column.size() + SELECT_LANES);
+  RowIndex *out = positions.data() + start;
+  size_t count = 0;
+  size_t row = 0;
+#if defined(SCORE_FILTER_HAS_SIMD)
+  for (; row + SELECT_LANES <= column.size(); row += SELECT_LANES) {
+    count += emit_positions(
+        out + count, first_row + static_cast<RowIndex>(row),
+        block_mask<Comparison>(column.data() + row, cutoff));
+  }
+#endif
+  for (; row < column.size(); ++row) {
+    out[count] = first_row + static_cast<RowIndex>(row);
+    count += compare<Comparison>(column[row], cutoff) ? 1 : 0;
+  }
+  positions.resize(start + count);
+}
+
+} // namespace score_filter_detail
+
+// --- append_selected_scores  ---
+// Appends to `positions` the positions of the stored scores that compare
+// against `cutoff` as `comparison` says, in storage order. `column` starts at
+// row `first_row`, so a column can be filtered a slice at a time.
+template <typename Stored, typename Cutoff>
+void append_selected_scores(std::span<const Stored> column, RowIndex first_row,
+                            ScoreComparison comparison, Cutoff cutoff,
+                            SelectionVector &positions) {
+  using namespace score_filter_detail;
+  switch (comparison) {
+  case ScoreComparison::Greater:
+    append_selected<ScoreComparison::Greater>(column, first_row, cutoff,
+                                              positions);
+    return;
+  case ScoreComparison::GreaterEqual:
+    append_selected<ScoreComparison::GreaterEqual>(column, first_row, cutoff,
+                                                   positions);
+    return;
+  case ScoreComparison::Less:
+    append_selected<ScoreComparison::Less>(column, first_row, cutoff,
+                                           positions);
+    return;
+  case ScoreComparison::LessEqual:
+    append_selected<ScoreComparison::LessEqual>(column, first_row, cutoff,
+                                                positions);
+    return;
+  }
+}
+
+// --- stored_score_matches  ---
+// Whether one stored score compares against `cutoff` as `comparison` says.
+template <typename Stored, typename Cutoff>
+auto stored_score_matches(Stored value, ScoreComparison comparison,
+                          Cutoff cutoff) -> bool {
+  using namespace score_filter_detail;
+  switch (comparison) {
+  case ScoreComparison::Greater:
+    return compare<ScoreComparison::Greater>(value, cutoff);
+  case ScoreComparison::GreaterEqual:
+    return compare<ScoreComparison::GreaterEqual>(value, cutoff);
+  case ScoreComparison::Less:
+    return compare<ScoreComparison::Less>(value, cutoff);
+  case ScoreComparison::LessEqual:
+    return compare<ScoreComparison::LessEqual>(value, cutoff);
+  }
+  return false;
+}
+
+// --- select_scores  ---
+// Positions of the stored scores that compare against `cutoff` as
+// `comparison` says, in storage order.
+template <typename Stored, typename Cutoff>
+auto select_scores(std::span<const Stored> column, ScoreComparison comparison,
+                   Cutoff cutoff) -> SelectionVector {
+  SelectionVector positions;
+  append_selected_scores(column, 0, comparison, cutoff, positions);
+  return positions;
+}
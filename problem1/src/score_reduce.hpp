@@ -0,0 +1,258 @@
+#pragma once
+
+#include <algorithm>   // For std::min, std::max
+#include <array>       // For per-lane accumulators
+#include <cmath>       // For std::sqrt
+#include <cstddef>     // For size_t
+#include <limits>      // For the min/max identities
+#include <span>        // C++20 for score columns
+#include <type_traits> // For std::conditional_t
+
+// --- ScoreSummary  ---
+// Count, sum, sum of squares and range of a set of scores.
+struct ScoreSummary {
+  size_t count = 0;
+  double sum = 0.0;
+  double sum_of_squares = 0.0;
+  double min = std::numeric_limits<double>::infinity();
+  double max = -std::numeric_limits<double>::infinity();
+
+  [[nodiscard]] auto mean() const -> double {
+    return count == 0 ? 0.0 : sum / static_cast<double>(count);
+  }
+};
+
+// --- CompensatedSum  ---
+// Kahan summation: `compensation` holds the low-order bits lost by `sum`, so
+// long runs of additions keep close to full double precision.
+struct CompensatedSum {
+  double sum = 0.0;
+  double compensation = 0.0; // Subtract from sum for the running total
+
+  void add(double value) { add_to(sum, compensation, value); }
+
+  // The same step on a sum and compensation held elsewhere.
+  static void add_to(double &sum, double &compensation, double value) {
+    const double corrected = value - compensation;
+    const double total = sum + corrected;
+    compensation = (total - sum) - corrected;
+    sum = total;
+  }
+
+  // Exact combination up to the final rounding: the error of sum + other.sum
+  // is recovered with Knuth's two-sum and folded into the compensation.
+  void merge(const CompensatedSum &other) {
+    const double total = sum + other.sum;
+    const double other_part = total - sum;
+    const double error =
+        (sum - (total - other_part)) + (other.sum - other_part);
+    compensation = compensation + other.compensation - error;
+    sum = total;
+  }
+
+  [[nodiscard]] auto value() const -> double { return sum - compensation; }
+};
+
+// --- StoredScoreSummary  ---
+// ScoreSummary of a stored score column, still in the codec's domain: sums use
+// the codec's accumulator (Kahan-compensated when that is floating point,
+// exact when it is an integer) and min/max are stored values. Partial
+// summaries of adjacent ranges merge without loss.
+template <typename Codec> struct StoredScoreSummary {
+  using Stored = typename Codec::Stored;
+  using Accumulator = typename Codec::Accumulator;
+  using Sum = std::conditional_t<std::is_floating_point_v<Accumulator>,
+                                 CompensatedSum, Accumulator>;
+
+  size_t count = 0;
+  Sum sum{};
+  Sum sum_of_squares{};
+  Stored min = std::numeric_limits<Stored>::max();
+  Stored max = std::numeric_limits<Stored>::lowest();
+
+  void add(Stored stored) {
+    const auto value = static_cast<Accumulator>(stored);
+    count++;
+    add_to_sum(sum, value);
+    add_to_sum(sum_of_squares, value * value);
+    min = std::min(min, stored);
+    max = std::max(max, stored);
+  }
+
+  void merge(const StoredScoreSummary &other) {
+    count += other.count;
+    merge_sum(sum, other.sum);
+    merge_sum(sum_of_squares, other.sum_of_squares);
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+  }
+
+  [[nodiscard]] auto decode() const -> ScoreSummary {
+    if (count == 0) {
+      return {};
+    }
+    return {.count = count,
+            .sum = Codec::sum_to_score(sum_value(sum)),
+            .sum_of_squares =
+                Codec::sum_of_squares_to_score(sum_value(sum_of_squares)),
+            .min = Codec::decode(min),
+            .max = Codec::decode(max)};
+  }
+
+  static void add_to_sum(Sum &target, Accumulator value) {
+    if constexpr (std::is_floating_point_v<Accumulator>) {
+      target.add(value);
+    } else {
+      target += value;
+    }
+  }
+  static void merge_sum(Sum &target, const Sum &other) {
+    if constexpr (std::is_floating_point_v<Accumulator>) {
+      target.merge(other);
+    } else {
+      target += other;
+    }
+  }
+  static auto sum_value(const Sum &total) -> Accumulator {
+    if constexpr (std::is_floating_point_v<Accumulator>) {
+      return total.value();
+    } else {
+      return total;
+    }
+  }
+};
+
+// --- summarize_stored_scores  ---
+// One pass with REDUCE_LANES independent accumulators of each kind, row i
+// feeding lane i % REDUCE_LANES. Each quantity keeps its lanes in an array of
+// its own, so a step over REDUCE_LANES rows is one vector operation per
+// quantity and no addition is reassociated; the lanes are then gathered into
+// StoredScoreSummary and merged pairwise.
+constexpr size_t REDUCE_LANES = 8;
+
+template <typename Codec>
+auto summarize_stored_scores(std::span<const typename Codec::Stored> column)
+    -> StoredScoreSummary<Codec> {
+  using Summary = StoredScoreSummary<Codec>;
+  using Stored = typename Codec::Stored;
+  using Accumulator = typename Codec::Accumulator;
+  constexpr bool COMPENSATED = std::is_floating_point_v<Accumulator>;
+  using Lanes = std::array<Accumulator, REDUCE_LANES>;
+  Lanes sum{};
+  Lanes sum_compensation{}; // Unused for integer accumulators
+  Lanes squares{};
+  Lanes squares_compensation{};
+  std::array<Stored, REDUCE_LANES> lo{};
+  std::array<Stored, REDUCE_LANES> hi{};
+  lo.fill(std::numeric_limits<Stored>::max());
+  hi.fill(std::numeric_limits<Stored>::lowest());
+
+  const auto add = [&](size_t lane, Stored stored) {
+    const auto value = static_cast<Accumulator>(stored);
+    const Accumulator square = value * value;
+    if constexpr (COMPENSATED) {
+      CompensatedSum::add_to(sum[lane], sum_compensation[lane], value);
+      CompensatedSum::add_to(squares[lane], squares_compensation[lane],
+                             square);
+    } else {
+      sum[lane] += value;
+      squares[lane] += square;
+    }
+    lo[lane] = std::min(lo[lane], stored);
+    hi[lane] = std::max(hi[lane], stored);
+  };
+  size_t row = 0;
+  for (; row + REDUCE_LANES <= column.size(); row += REDUCE_LANES) {
+    for (size_t lane = 0; lane < REDUCE_LANES; ++lane) {
+      add(lane, column[row + lane]);
+    }
+  }
+  for (size_t lane = 0; row < column.size(); ++row, ++lane) {
+    add(lane, column[row]);
+  }
+
+  std::array<Summary, REDUCE_LANES> lanes{};
+  for (size_t lane = 0; lane < REDUCE_LANES; ++lane) {
+    if constexpr (COMPENSATED) {
+      lanes[lane].sum = {.sum = sum[lane],
+                         .compensation = sum_compensation[lane]};
+      lanes[lane].sum_of_squares = {.sum = squares[lane],
+                                    .compensation = squares_compensation[lane]};
+    } else {
+      lanes[lane].sum = sum[lane];
+      lanes[lane].sum_of_squares = squares[lane];
+    }
+    lanes[lane].min = lo[lane];
+    lanes[lane].max = hi[lane];
+  }
+  for (size_t stride = 1; stride < REDUCE_LANES; stride *= 2) {
+    for (size_t lane = 0; lane + stride < REDUCE_LANES; lane += 2 * stride) {
+      lanes[lane].merge(lanes[lane + stride]);
+    }
+  }
+  lanes[0].count = column.size();
+  return lanes[0];
+}
+
+// --- ScoreStatistics  ---
+// Count, mean, variance and range of a set of scores, updated one score at a
+// time with Welford's recurrence: `m2` is the sum of squared deviations from
+// the running mean, which stays accurate where sum_of_squares - sum^2 / n
+// cancels. Statistics of disjoint sets merge with Chan et al.'s formula, so
+// chunks can be accumulated independently and combined.
+struct ScoreStatistics {
+  size_t count = 0;
+  double mean = 0.0;
+  double m2 = 0.0;
+  double min = std::numeric_limits<double>::infinity();
+  double max = -std::numeric_limits<double>::infinity();
+
+  void add(double score) {
+    count++;
+    const double delta = score - mean;
+    mean += delta / static_cast<double>(count);
+    m2 += delta * (score - mean);
+    min = std::min(min, score);
+    max = std::max(max, score);
+  }
+
+  void merge(const ScoreStatistics &other) {
+    if (other.count == 0) {
+      return;
+    }
+    if (count == 0) {
+      *this = other;
+      return;
+    }
+    const auto n_a = static_cast<double>(count);
+    const auto n_b = static_cast<double>(other.count);
+    const double total = n_a + n_b;
+    const double delta = other.mean - mean;
+    mean += delta * (n_b / total);
+    m2 += other.m2 + delta * delta * (n_a * n_b / total);
+    count += other.count;
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+  }
+
+  // Population variance: the scores are the whole cohort, not a sample.
+  [[nodiscard]] auto variance() const -> double {
+    return count == 0 ? 0.0 : m2 / static_cast<double>(count);
+  }
+  [[nodiscard]] auto sample_variance() const -> double {
+    return count < 2 ? 0.0 : m2 / static_cast<double>(count - 1);
+  }
+  [[nodiscard]] auto stddev() const -> double { return std::sqrt(variance()); }
+};
+
+// --- accumulate_score_statistics  ---
+// ScoreStatistics of a stored score column, decoding each score as it goes.
+template <typename Codec>
+auto accumulate_score_statistics(
+    std::span<const typename Codec::Stored> column) -> ScoreStatistics {
+  ScoreStatistics statistics;
+  for (const auto stored : column) {
+    statistics.add(Codec::decode(stored));
+  }
+  return statistics;
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <algorithm>  // For std::min, the sorts and heap operations
+#include <array>      // For digit histograms
+#include <bit>        // For std::bit_cast
+#include <cstddef>    // For size_t, std::ptrdiff_t
+#include <cstdint>    // For radix keys
+#include <functional> // For std::greater
+#include <numeric>    // For std::iota
+#include <span>       // C++20 for score columns
+#include <utility>    // For std::swap
+#include <vector>     // For keys and permutations
+
+#include "score_filter.hpp"
+#include "task_pool.hpp"
+
+// --- Radix keys  ---
+// Unsigned integers that order like the stored scores. An IEEE value maps to
+// its bit pattern with the sign bit flipped if non-negative, or with every
+// bit flipped if negative; a fixed-point value is its own key. Adding +0.0
+// first turns -0.0 into +0.0, which compares equal to it.
+inline auto radix_key(double value) -> std::uint64_t {
+  const auto bits = std::bit_cast<std::uint64_t>(value + 0.0);
+  const std::uint64_t flip =
+      (bits >> 63U) != 0 ? ~std::uint64_t{0} : std::uint64_t{1} << 63U;
+  return bits ^ flip;
+}
+inline auto radix_key(float value) -> std::uint32_t {
+  const auto bits = std::bit_cast<std::uint32_t>(value + 0.0F);
+  const std::uint32_t flip =
+      (bits >> 31U) != 0 ? ~std::uint32_t{0} : std::uint32_t{1} << 31U;
+  return bits ^ flip;
+}
+inline auto radix_key(std::uint16_t value) -> std::uint16_t { return value; }
+
+// Below this many rows a comparison sort beats the fixed cost of the radix
+// passes.
+constexpr size_t RADIX_SORT_MIN_ROWS = size_t{1} << 12;
+
+namespace score_sort_detail {
+
+constexpr size_t RADIX_BITS = 8;
+constexpr size_t RADIX_BUCKETS = size_t{1} << RADIX_BITS;
+// Rows per chunk at the least; each chunk keeps a histogram per pass.
+constexpr size_t RADIX_MIN_CHUNK_ROWS = size_t{1} << 14;
+
+using Histogram = std::array<size_t, RADIX_BUCKETS>;
+
+template <typename Key> auto digit(Key key, size_t pass) -> size_t {
+  return static_cast<size_t>(key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1);
+}
+
+} // namespace score_sort_detail
+
+// --- radix_sort_descending  ---
+// Row positions of `column` ordered by descending score, equal scores keeping
+// their storage order. LSD radix sort on the radix keys, one 8-bit digit per
+// pass: every pass counts digits per chunk, turns the counts into each
+// chunk's output offsets, and scatters the chunk's (key, row) pairs there.
+// Chunks run on `pool`; a pass whose digit is the same for every row (the
+// high exponent bits of bounded scores) is skipped.
+template <typename Stored>
+auto radix_sort_descending(std::span<const Stored> column, TaskPool &pool)
+    -> std::vector<RowIndex> {
+  using namespace score_sort_detail;
+  using Key = decltype(radix_key(Stored{}));
+  const size_t rows = column.size();
+  const size_t chunks = std::max<size_t>(
+      std::min(pool.concurrency(), rows / RADIX_MIN_CHUNK_ROWS), 1);
+  const size_t chunk_rows = (rows + chunks - 1) / chunks;
+  auto chunk_begin = [&](size_t chunk) {
+    return std::min(chunk * chunk_rows, rows);
+  };
+
+  // Inverted keys: ascending order on them is descending order on scores.
+  std::vector<Key> keys(rows);
+  std::vector<RowIndex> order(rows);
+  pool.parallel_for(chunks, [&](size_t chunk) {
+    for (size_t row = chunk_begin(chunk); row < chunk_begin(chunk + 1);
+         ++row) {
+      keys[row] = static_cast<Key>(~radix_key(column[row]));
+      order[row] = static_cast<RowIndex>(row);
+    }
+  });
+
+  std::vector<Key> next_keys(rows);
+  std::vector<RowIndex> next_order(rows);
+  std::vector<Histogram> counts(chunks);
+  for (size_t pass = 0; pass < sizeof(Key) * 8 / RADIX_BITS; ++pass) {
+    pool.parallel_for(chunks, [&](size_t chunk) {
+      counts[chunk].fill(0);
+      for (size_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i) {
+        counts[chunk][digit(keys[i], pass)]++;
+      }
+    });
+
+    // Exclusive prefix over (digit, chunk): chunk c's rows with digit d go
+    // after every row with a smaller digit and after earlier chunks' d's.
+    size_t total = 0;
+    bool single_digit = false;
+    for (size_t d = 0; d < RADIX_BUCKETS; ++d) {
+      const size_t digit_start = total;
+      for (Histogram &count : counts) {
+        const size_t chunk_count = count[d];
+        count[d] = total;
+        total += chunk_count;
+      }
+      single_digit = single_digit || total - digit_start == rows;
+    }
+    if (single_digit) {
+      continue;
+    }
+
+    pool.parallel_for(chunks, [&](size_t chunk) {
+      Histogram &offsets = counts[chunk];
+      for (size_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i) {
+        const size_t to = offsets[digit(keys[i], pass)]++;
+        next_keys[to] = keys[i];
+        next_order[to] = order[i];
+      }
+    });
+    std::swap(keys, next_keys);
+    std::swap(order, next_order);
+  }
+  return order;
+}
+
+// --- sort_positions_descending  ---
+// Row positions of `column` by descending score: the radix sort from
+// RADIX_SORT_MIN_ROWS rows up, a stable comparison sort below; either way
+// equal scores keep their storage order.
+template <typename Stored>
+auto sort_positions_descending(std::span<const Stored> column, TaskPool &pool)
+    -> std::vector<RowIndex> {
+  if (column.size() >= RADIX_SORT_MIN_ROWS) {
+    return radix_sort_descending(column, pool);
+  }
+  std::vector<RowIndex> order(column.size());
+  std::iota(order.begin(), order.end(), RowIndex{0});
+  std::ranges::stable_sort(order, std::greater<>{},
+                           [column](RowIndex row) { return column[row]; });
+  return order;
+}
+
+// --- top_k_descending  ---
+// The first `k` positions of sort_positions_descending(column), without
+// sorting the rest: every chunk keeps its k best rows in a heap whose root is
+// the worst of them, so most rows cost one comparison against the root. The
+// chunk heaps are then merged and only the k winners are sorted. Ties go to
+// the lower row, as in the full sort.
+template <typename Stored>
+auto top_k_descending(std::span<const Stored> column, size_t k,
+                      TaskPool &pool) -> std::vector<RowIndex> {
+  using namespace score_sort_detail;
+  k = std::min(k, column.size());
+  if (k == 0) {
+    return {};
+  }
+  auto better = [column](RowIndex lhs, RowIndex rhs) {
+    return column[lhs] > column[rhs] ||
+           (column[lhs] == column[rhs] && lhs < rhs);
+  };
+  const size_t rows = column.size();
+  const size_t chunks = std::max<size_t>(
+      std::min(pool.concurrency(), rows / RADIX_MIN_CHUNK_ROWS), 1);
+  const size_t chunk_rows = (rows + chunks - 1) / chunks;
+
+  std::vector<std::vector<RowIndex>> heaps(chunks);
+  pool.parallel_for(chunks, [&](size_t chunk) {
+    std::vector<RowIndex> &heap = heaps[chunk];
+    const size_t end = std::min((chunk + 1) * chunk_rows, rows);
+    for (size_t row = chunk * chunk_rows; row < end; ++row) {
+      const auto position = static_cast<RowIndex>(row);
+      if (heap.size() < k) {
+        heap.push_back(position);
+        std::ranges::push_heap(heap, better);
+      } else if (better(position, heap.front())) {
+        std::ranges::pop_heap(heap, better);
+        heap.back() = position;
+        std::ranges::push_heap(heap, better);
+      }
+    }
+  });
+
+  std::vector<RowIndex> top;
+  top.reserve(chunks * k);
+  for (const std::vector<RowIndex> &heap : heaps) {
+    top.insert(top.end(), heap.begin(), heap.end());
+  }
+  std::ranges::nth_element(top, top.begin() + static_cast<std::ptrdiff_t>(k),
+                           better);
+  top.resize(k);
+  std::ranges::sort(top, better);
+  return top;
+}
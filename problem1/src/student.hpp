@@ -0,0 +1,113 @@
+#pragma once
+
+#include <concepts> // For defining range concepts
+#include <cstddef>  // For size_t
+#include <cstdint>  // For the error code width
+#include <expected> // C++23 for error handling
+#include <format>   // For the GenError formatter
+#include <ranges>   // For range concepts
+#include <string_view> // For the formatter base
+#include <type_traits> // For trivially-copyable checks
+
+// --- Structs, Concepts, Constants  ---
+struct Student {
+  int id;
+  double score;
+};
+template <typename R>
+concept StudentRange = std::ranges::input_range<R> &&
+                       std::same_as<std::ranges::range_value_t<R>, Student>;
+
+constexpr size_t NUM_STUDENTS = 30;
+constexpr double MAX_SCORE = 100.0;
+constexpr double MIN_SCORE = 0.0;
+constexpr double PASS_THRESHOLD = 60.0;
+constexpr double EXCELLENT_THRESHOLD = 85.0;
+constexpr size_t TOP_K_STUDENTS = 10; // Rows the leaderboard step lists
+constexpr double SCORE_MEAN_CENTER = 70.0;
+constexpr double SCORE_STD_DEV = 30.0;
+
+// --- ScorePredicate  ---
+// A threshold comparison on the score. Callable on a Student like any filter
+// lambda, but also inspectable, so column stores can evaluate it directly on
+// their stored score encoding.
+enum class ScoreComparison : std::uint8_t {
+  Greater,
+  GreaterEqual,
+  Less,
+  LessEqual
+};
+
+struct ScorePredicate {
+  ScoreComparison comparison;
+  double threshold;
+
+  auto operator()(const Student &student) const -> bool {
+    switch (comparison) {
+    case ScoreComparison::Greater:
+      return student.score > threshold;
+    case ScoreComparison::GreaterEqual:
+      return student.score >= threshold;
+    case ScoreComparison::Less:
+      return student.score < threshold;
+    case ScoreComparison::LessEqual:
+      return student.score <= threshold;
+    }
+    return false;
+  }
+};
+
+constexpr auto score_greater(double threshold) -> ScorePredicate {
+  return {.comparison = ScoreComparison::Greater, .threshold = threshold};
+}
+constexpr auto score_at_least(double threshold) -> ScorePredicate {
+  return {.comparison = ScoreComparison::GreaterEqual, .threshold = threshold};
+}
+constexpr auto score_less(double threshold) -> ScorePredicate {
+  return {.comparison = ScoreComparison::Less, .threshold = threshold};
+}
+constexpr auto score_at_most(double threshold) -> ScorePredicate {
+  return {.comparison = ScoreComparison::LessEqual, .threshold = threshold};
+}
+
+// --- GenError  ---
+// Compact, trivially copyable failure record: failing a generation costs no
+// allocation, and the text is only built when the error is reported.
+enum class GenErrorCode : std::uint8_t {
+  SimulatedFailure,     // Injected fault, raw_score is the discarded draw
+  ScoreOutOfRange,      // raw_score fell outside [MIN_SCORE, MAX_SCORE]
+  RetryBudgetExhausted, // raw_score is the last failed attempt's draw
+};
+
+struct GenError {
+  double raw_score;
+  int student_id;
+  GenErrorCode code;
+};
+static_assert(std::is_trivially_copyable_v<GenError>);
+static_assert(sizeof(GenError) == 16);
+
+using SingleStudentResult = std::expected<Student, GenError>;
+
+// Reporting layer: the message is produced here, not at the failure site.
+template <>
+struct std::formatter<GenError> : std::formatter<std::string_view> {
+  auto format(const GenError &error, std::format_context &ctx) const {
+    switch (error.code) {
+    case GenErrorCode::SimulatedFailure:
+      return std::format_to(ctx.out(), "Generation failed: {}",
+                            "Simulated random error");
+    case GenErrorCode::ScoreOutOfRange:
+      return std::format_to(
+          ctx.out(),
+          "Generation failed: Raw score {:.2f} out of range [{:.1f}, {:.1f}]",
+          error.raw_score, MIN_SCORE, MAX_SCORE);
+    case GenErrorCode::RetryBudgetExhausted:
+      return std::format_to(ctx.out(),
+                            "Generation failed: ID {} exhausted its retry "
+                            "budget (last raw score {:.2f})",
+                            error.student_id, error.raw_score);
+    }
+    return std::format_to(ctx.out(), "Generation failed: unknown error");
+  }
+};
@@ -0,0 +1,527 @@
+#pragma once
+
+#include <algorithm>   // For std::min
+#include <array>       // For file magics and header padding
+#include <cstddef>     // For size_t, std::byte
+#include <cstdint>     // For the fixed-width file fields
+#include <cstdio>      // For std::FILE, std::fwrite, std::fread
+#include <expected>    // C++23 for error handling
+#include <filesystem>  // For export paths
+#include <format>      // For the ExportError formatter
+#include <memory>      // For std::unique_ptr file handles
+#include <span>        // C++20 for positions and mapped columns
+#include <string_view> // For the formatter base
+#include <system_error> // For file-size errors without mmap
+#include <type_traits> // For trivially-copyable checks
+#include <utility>     // For std::exchange, std::move
+#include <vector>      // For write batches and the read fallback
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>    // For ::open
+#include <sys/mman.h> // For ::mmap, ::munmap
+#include <sys/stat.h> // For ::fstat
+#include <unistd.h>   // For ::close
+#define STUDENT_EXPORT_MMAP 1
+#endif
+
+#include "score_codec.hpp"
+#include "score_filter.hpp"
+#include "student.hpp"
+#include "student_table.hpp"
+
+// --- ExportError  ---
+enum class ExportError : std::uint8_t {
+  OpenFailed,  // The file could not be created or opened
+  WriteFailed, // A write came up short (disk full, closed pipe, ...)
+  ReadFailed,  // The file could not be mapped or read back
+  BadFormat,   // Wrong magic, version, byte order or sizes
+};
+
+template <>
+struct std::formatter<ExportError> : std::formatter<std::string_view> {
+  auto format(ExportError error, std::format_context &ctx) const {
+    switch (error) {
+    case ExportError::OpenFailed:
+      return std::format_to(ctx.out(), "Export failed: cannot open file");
+    case ExportError::WriteFailed:
+      return std::format_to(ctx.out(), "Export failed: short write");
+    case ExportError::ReadFailed:
+      return std::format_to(ctx.out(), "Export failed: cannot read file");
+    case ExportError::BadFormat:
+      return std::format_to(ctx.out(), "Export failed: not an export file "
+                                       "of this version and byte order");
+    }
+    return std::format_to(ctx.out(), "Export failed: unknown error");
+  }
+};
+
+// --- File layouts  ---
+// Both formats are a 64-byte header followed by fixed-width binary data in
+// the writer's native byte order, which the header records as
+// EXPORT_BYTE_ORDER_MARK; a reader that sees the mark byte-swapped rejects
+// the file. Nothing is formatted as text, and a reader can mmap the file and
+// use the data in place.
+//
+// Row file (".rows"): RowFileHeader, then row_count ExportedRow records.
+// Column file (".cols"): ColumnFileHeader, then row_count int32 ids at
+// id_offset and row_count stored scores at score_offset, each column
+// starting on an EXPORT_ALIGNMENT boundary. Scores keep the table's stored
+// encoding (score_storage, a ScoreStorage value), so exporting a column is a
+// copy and readers decode it with the matching ScoreCodecFor.
+constexpr std::uint32_t EXPORT_BYTE_ORDER_MARK = 0x01020304;
+constexpr std::uint32_t EXPORT_VERSION = 1;
+constexpr size_t EXPORT_ALIGNMENT = 64;
+constexpr std::array<char, 8> ROW_FILE_MAGIC{'S', 'T', 'U', 'R',
+                                             'O', 'W', 'S', '1'};
+constexpr std::array<char, 8> COLUMN_FILE_MAGIC{'S', 'T', 'U', 'C',
+                                                'O', 'L', 'S', '1'};
+
+struct RowFileHeader {
+  std::array<char, 8> magic;
+  std::uint32_t byte_order;
+  std::uint32_t version;
+  std::uint64_t row_count;
+  std::uint32_t row_bytes; // sizeof(ExportedRow)
+  std::array<std::uint8_t, 36> reserved;
+};
+static_assert(std::is_trivially_copyable_v<RowFileHeader>);
+static_assert(sizeof(RowFileHeader) == EXPORT_ALIGNMENT);
+
+struct ExportedRow {
+  std::int32_t id;
+  std::uint32_t reserved; // Zero; keeps the score 8-byte aligned
+  double score;
+};
+static_assert(std::is_trivially_copyable_v<ExportedRow>);
+static_assert(sizeof(ExportedRow) == 16);
+
+struct ColumnFileHeader {
+  std::array<char, 8> magic;
+  std::uint32_t byte_order;
+  std::uint32_t version;
+  std::uint64_t row_count;
+  std::uint64_t id_offset;    // Bytes from the start of the file
+  std::uint64_t score_offset; // Bytes from the start of the file
+  std::uint8_t score_storage; // A ScoreStorage value
+  std::uint8_t score_bytes;   // sizeof the stored score
+  std::array<std::uint8_t, 22> reserved;
+};
+static_assert(std::is_trivially_copyable_v<ColumnFileHeader>);
+static_assert(sizeof(ColumnFileHeader) == EXPORT_ALIGNMENT);
+
+// What an export wrote.
+struct ExportReport {
+  size_t rows;
+  size_t bytes;
+};
+
+namespace student_export_detail {
+
+// Rows gathered per fwrite when exporting a selection.
+constexpr size_t EXPORT_BATCH_ROWS = size_t{1} << 14;
+
+using FileHandle = std::unique_ptr<std::FILE, int (*)(std::FILE *)>;
+
+inline auto open_for_writing(const std::filesystem::path &path)
+    -> std::expected<FileHandle, ExportError> {
+  FileHandle file(std::fopen(path.string().c_str(), "wb"), &std::fclose);
+  if (file == nullptr) {
+    return std::unexpected(ExportError::OpenFailed);
+  }
+  return file;
+}
+
+inline auto write_bytes(std::FILE *file, const void *data, size_t bytes)
+    -> bool {
+  return bytes == 0 || std::fwrite(data, 1, bytes, file) == bytes;
+}
+
+template <typename T>
+auto write_span(std::FILE *file, std::span<const T> values) -> bool {
+  return write_bytes(file, values.data(), values.size_bytes());
+}
+
+// Closes `file` after a successful write of `rows` rows in `bytes` bytes,
+// reporting a failed final flush as a short write.
+inline auto finish(FileHandle file, size_t rows, size_t bytes)
+    -> std::expected<ExportReport, ExportError> {
+  if (std::fclose(file.release()) != 0) {
+    return std::unexpected(ExportError::WriteFailed);
+  }
+  return ExportReport{.rows = rows, .bytes = bytes};
+}
+
+constexpr auto align_up(std::uint64_t offset) -> std::uint64_t {
+  return (offset + EXPORT_ALIGNMENT - 1) / EXPORT_ALIGNMENT * EXPORT_ALIGNMENT;
+}
+
+// Writes `count` values, the i-th being `value_at(i)`, EXPORT_BATCH_ROWS at a
+// time through one reused buffer.
+template <typename T, typename ValueAt>
+auto write_gathered(std::FILE *file, size_t count, ValueAt value_at) -> bool {
+  std::vector<T> batch;
+  batch.reserve(std::min(count, EXPORT_BATCH_ROWS));
+  for (size_t begin = 0; begin < count; begin += EXPORT_BATCH_ROWS) {
+    const size_t end = std::min(count, begin + EXPORT_BATCH_ROWS);
+    batch.clear();
+    for (size_t i = begin; i < end; ++i) {
+      batch.push_back(value_at(i));
+    }
+    if (!write_span(file, std::span<const T>(batch))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename Codec, typename RowAt>
+auto export_rows_by(const std::filesystem::path &path,
+                    const BasicStudentTable<Codec> &table, size_t count,
+                    RowAt row_at) -> std::expected<ExportReport, ExportError> {
+  auto file = open_for_writing(path);
+  if (!file) {
+    return std::unexpected(file.error());
+  }
+  const RowFileHeader header{.magic = ROW_FILE_MAGIC,
+                             .byte_order = EXPORT_BYTE_ORDER_MARK,
+                             .version = EXPORT_VERSION,
+                             .row_count = count,
+                             .row_bytes = sizeof(ExportedRow),
+                             .reserved = {}};
+  const bool written =
+      write_bytes(file->get(), &header, sizeof(header)) &&
+      write_gathered<ExportedRow>(file->get(), count, [&](size_t i) {
+        const size_t row = row_at(i);
+        return ExportedRow{.id = table.id_at(row),
+                           .reserved = 0,
+                           .score = table.score_at(row)};
+      });
+  if (!written) {
+    return std::unexpected(ExportError::WriteFailed);
+  }
+  return finish(std::move(*file), count,
+                sizeof(header) + count * sizeof(ExportedRow));
+}
+
+// `positions` empty with `all_rows` set means the whole table in storage
+// order, whose score column is then written straight from the table.
+template <typename Codec>
+auto export_columns_of(const std::filesystem::path &path,
+                       const BasicStudentTable<Codec> &table,
+                       std::span<const RowIndex> positions, bool all_rows)
+    -> std::expected<ExportReport, ExportError> {
+  using Stored = typename Codec::Stored;
+  auto file = open_for_writing(path);
+  if (!file) {
+    return std::unexpected(file.error());
+  }
+  const size_t count = all_rows ? table.size() : positions.size();
+  auto row_at = [&](size_t i) -> size_t {
+    return all_rows ? i : positions[i];
+  };
+  const std::uint64_t id_offset = sizeof(ColumnFileHeader);
+  const std::uint64_t score_offset =
+      align_up(id_offset + count * sizeof(std::int32_t));
+  const ColumnFileHeader header{
+      .magic = COLUMN_FILE_MAGIC,
+      .byte_order = EXPORT_BYTE_ORDER_MARK,
+      .version = EXPORT_VERSION,
+      .row_count = count,
+      .id_offset = id_offset,
+      .score_offset = score_offset,
+      .score_storage = static_cast<std::uint8_t>(SCORE_STORAGE_OF<Codec>),
+      .score_bytes = sizeof(Stored),
+      .reserved = {}};
+  const std::array<std::byte, EXPORT_ALIGNMENT> padding{};
+  const auto scores = table.stored_scores();
+  const bool written =
+      write_bytes(file->get(), &header, sizeof(header)) &&
+      write_gathered<std::int32_t>(
+          file->get(), count,
+          [&](size_t i) -> std::int32_t { return table.id_at(row_at(i)); }) &&
+      write_bytes(file->get(), padding.data(),
+                  score_offset - id_offset - count * sizeof(std::int32_t)) &&
+      (all_rows ? write_span(file->get(), scores)
+                : write_gathered<Stored>(file->get(), count, [&](size_t i) {
+                    return scores[positions[i]];
+                  }));
+  if (!written) {
+    return std::unexpected(ExportError::WriteFailed);
+  }
+  return finish(std::move(*file), count,
+                score_offset + count * sizeof(Stored));
+}
+
+} // namespace student_export_detail
+
+// --- Writers  ---
+// Write `table` (or the rows at `positions`, in that order) to `path`,
+// replacing the file.
+template <typename Codec>
+auto export_rows(const std::filesystem::path &path,
+                 const BasicStudentTable<Codec> &table)
+    -> std::expected<ExportReport, ExportError> {
+  return student_export_detail::export_rows_by(
+      path, table, table.size(), [](size_t i) { return i; });
+}
+
+template <typename Codec>
+auto export_rows(const std::filesystem::path &path,
+                 const BasicStudentTable<Codec> &table,
+                 std::span<const RowIndex> positions)
+    -> std::expected<ExportReport, ExportError> {
+  return student_export_detail::export_rows_by(
+      path, table, positions.size(),
+      [positions](size_t i) -> size_t { return positions[i]; });
+}
+
+template <typename Codec>
+auto export_columns(const std::filesystem::path &path,
+                    const BasicStudentTable<Codec> &table)
+    -> std::expected<ExportReport, ExportError> {
+  return student_export_detail::export_columns_of(path, table, {}, true);
+}
+
+template <typename Codec>
+auto export_columns(const std::filesystem::path &path,
+                    const BasicStudentTable<Codec> &table,
+                    std::span<const RowIndex> positions)
+    -> std::expected<ExportReport, ExportError> {
+  return student_export_detail::export_columns_of(path, table, positions,
+                                                  false);
+}
+
+// --- MappedFile  ---
+// A whole file, read-only: mmap'd where the platform has it, read into memory
+// otherwise. Move-only; the bytes stay valid for the object's lifetime.
+class MappedFile {
+public:
+  static auto open(const std::filesystem::path &path)
+      -> std::expected<MappedFile, ExportError> {
+    MappedFile mapped;
+#if defined(STUDENT_EXPORT_MMAP)
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return std::unexpected(ExportError::OpenFailed);
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+      ::close(fd);
+      return std::unexpected(ExportError::ReadFailed);
+    }
+    mapped.size_ = static_cast<size_t>(info.st_size);
+    if (mapped.size_ > 0) {
+      void *address =
+          ::mmap(nullptr, mapped.size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (address == MAP_FAILED) {
+        ::close(fd);
+        return std::unexpected(ExportError::ReadFailed);
+      }
+      mapped.data_ = static_cast<const std::byte *>(address);
+    }
+    ::close(fd); // The mapping outlives the descriptor
+#else
+    const student_export_detail::FileHandle file(
+        std::fopen(path.string().c_str(), "rb"), &std::fclose);
+    if (file == nullptr) {
+      return std::unexpected(ExportError::OpenFailed);
+    }
+    std::error_code error;
+    mapped.buffer_.resize(std::filesystem::file_size(path, error));
+    if (error || std::fread(mapped.buffer_.data(), 1, mapped.buffer_.size(),
+                            file.get()) != mapped.buffer_.size()) {
+      return std::unexpected(ExportError::ReadFailed);
+    }
+    mapped.data_ = mapped.buffer_.data();
+    mapped.size_ = mapped.buffer_.size();
+#endif
+    return mapped;
+  }
+
+  MappedFile(MappedFile &&other) noexcept
+      : data_(std::exchange(other.data_, nullptr)),
+        size_(std::exchange(other.size_, 0)),
+        buffer_(std::move(other.buffer_)) {}
+  auto operator=(MappedFile &&other) noexcept -> MappedFile & {
+    if (this != &other) {
+      release();
+      data_ = std::exchange(other.data_, nullptr);
+      size_ = std::exchange(other.size_, 0);
+      buffer_ = std::move(other.buffer_);
+    }
+    return *this;
+  }
+  MappedFile(const MappedFile &) = delete;
+  auto operator=(const MappedFile &) -> MappedFile & = delete;
+  ~MappedFile() { release(); }
+
+  [[nodiscard]] auto bytes() const -> std::span<const std::byte> {
+    return {data_, size_};
+  }
+
+private:
+  MappedFile() = default;
+
+  void release() {
+#if defined(STUDENT_EXPORT_MMAP)
+    if (data_ != nullptr) {
+      ::munmap(const_cast<std::byte *>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+  }
+
+  const std::byte *data_ = nullptr;
+  size_t size_ = 0;
+  std::vector<std::byte> buffer_; // Holds the file without mmap
+};
+
+// --- Readers  ---
+// Views of an export file, validated on open. Their columns point into the
+// mapping, so reading them costs no parsing and no copy.
+class RowExportView {
+public:
+  static auto open(const std::filesystem::path &path)
+      -> std::expected<RowExportView, ExportError> {
+    auto file = MappedFile::open(path);
+    if (!file) {
+      return std::unexpected(file.error());
+    }
+    const auto bytes = file->bytes();
+    if (bytes.size() < sizeof(RowFileHeader)) {
+      return std::unexpected(ExportError::BadFormat);
+    }
+    const auto &header =
+        *reinterpret_cast<const RowFileHeader *>(bytes.data());
+    if (header.magic != ROW_FILE_MAGIC ||
+        header.byte_order != EXPORT_BYTE_ORDER_MARK ||
+        header.version != EXPORT_VERSION ||
+        header.row_bytes != sizeof(ExportedRow) ||
+        (bytes.size() - sizeof(header)) / sizeof(ExportedRow) <
+            header.row_count) {
+      return std::unexpected(ExportError::BadFormat);
+    }
+    return RowExportView(std::move(*file));
+  }
+
+  [[nodiscard]] auto size() const -> size_t { return rows().size(); }
+  [[nodiscard]] auto rows() const -> std::span<const ExportedRow> {
+    const auto bytes = file_.bytes();
+    return {reinterpret_cast<const ExportedRow *>(bytes.data() +
+                                                  sizeof(RowFileHeader)),
+            static_cast<size_t>(header().row_count)};
+  }
+  [[nodiscard]] auto operator[](size_t row) const -> Student {
+    return {.id = rows()[row].id, .score = rows()[row].score};
+  }
+
+private:
+  explicit RowExportView(MappedFile file) : file_(std::move(file)) {}
+
+  [[nodiscard]] auto header() const -> const RowFileHeader & {
+    return *reinterpret_cast<const RowFileHeader *>(file_.bytes().data());
+  }
+
+  MappedFile file_;
+};
+
+class ColumnExportView {
+public:
+  static auto open(const std::filesystem::path &path)
+      -> std::expected<ColumnExportView, ExportError> {
+    auto file = MappedFile::open(path);
+    if (!file) {
+      return std::unexpected(file.error());
+    }
+    const auto bytes = file->bytes();
+    if (bytes.size() < sizeof(ColumnFileHeader)) {
+      return std::unexpected(ExportError::BadFormat);
+    }
+    const auto &header =
+        *reinterpret_cast<const ColumnFileHeader *>(bytes.data());
+    const size_t score_bytes = stored_bytes(header.score_storage);
+    if (header.magic != COLUMN_FILE_MAGIC ||
+        header.byte_order != EXPORT_BYTE_ORDER_MARK ||
+        header.version != EXPORT_VERSION || score_bytes == 0 ||
+        header.score_bytes != score_bytes ||
+        header.id_offset % EXPORT_ALIGNMENT != 0 ||
+        header.score_offset % EXPORT_ALIGNMENT != 0 ||
+        !fits(bytes.size(), header.id_offset, header.row_count,
+              sizeof(std::int32_t)) ||
+        !fits(bytes.size(), header.score_offset, header.row_count,
+              score_bytes)) {
+      return std::unexpected(ExportError::BadFormat);
+    }
+    return ColumnExportView(std::move(*file));
+  }
+
+  [[nodiscard]] auto size() const -> size_t {
+    return static_cast<size_t>(header().row_count);
+  }
+  [[nodiscard]] auto score_storage() const -> ScoreStorage {
+    return static_cast<ScoreStorage>(header().score_storage);
+  }
+  [[nodiscard]] auto ids() const -> std::span<const std::int32_t> {
+    return {reinterpret_cast<const std::int32_t *>(file_.bytes().data() +
+                                                   header().id_offset),
+            size()};
+  }
+  // The score column in its stored encoding; `Codec` must match
+  // score_storage().
+  template <typename Codec>
+  [[nodiscard]] auto stored_scores() const
+      -> std::span<const typename Codec::Stored> {
+    using Stored = typename Codec::Stored;
+    return {reinterpret_cast<const Stored *>(file_.bytes().data() +
+                                             header().score_offset),
+            size()};
+  }
+  [[nodiscard]] auto score_at(size_t row) const -> double {
+    switch (score_storage()) {
+    case ScoreStorage::Float64:
+      return decode_at<ScoreCodecFor<ScoreStorage::Float64>>(row);
+    case ScoreStorage::Float32:
+      return decode_at<ScoreCodecFor<ScoreStorage::Float32>>(row);
+    case ScoreStorage::FixedPoint16:
+      return decode_at<ScoreCodecFor<ScoreStorage::FixedPoint16>>(row);
+    }
+    return 0.0;
+  }
+  [[nodiscard]] auto operator[](size_t row) const -> Student {
+    return {.id = ids()[row], .score = score_at(row)};
+  }
+
+private:
+  explicit ColumnExportView(MappedFile file) : file_(std::move(file)) {}
+
+  // sizeof the stored score of a ScoreStorage value, 0 if it names none.
+  static auto stored_bytes(std::uint8_t storage) -> size_t {
+    switch (static_cast<ScoreStorage>(storage)) {
+    case ScoreStorage::Float64:
+      return sizeof(ScoreCodecFor<ScoreStorage::Float64>::Stored);
+    case ScoreStorage::Float32:
+      return sizeof(ScoreCodecFor<ScoreStorage::Float32>::Stored);
+    case ScoreStorage::FixedPoint16:
+      return sizeof(ScoreCodecFor<ScoreStorage::FixedPoint16>::Stored);
+    }
+    return 0;
+  }
+
+  // Whether `count` values of `width` bytes at `offset` lie inside `size`.
+  static auto fits(size_t size, std::uint64_t offset, std::uint64_t count,
+                   size_t width) -> bool {
+    return offset <= size && (size - offset) / width >= count;
+  }
+
+  template <typename Codec>
+  [[nodiscard]] auto decode_at(size_t row) const -> double {
+    return Codec::decode(stored_scores<Codec>()[row]);
+  }
+
+  [[nodiscard]] auto header() const -> const ColumnFileHeader & {
+    return *reinterpret_cast<const ColumnFileHeader *>(file_.bytes().data());
+  }
+
+  MappedFile file_;
+};
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <algorithm> // For std::min, std::max, heap operations
+#include <array>     // For per-worker sample blocks
+#include <chrono>    // For retry ready times
+#include <cstddef>   // For size_t
+#include <cstdint>   // For fixed-width seed/counter types
+#include <expected>  // C++23 for error handling
+#include <optional>  // For the exhausted-budget marker
+#include <span>      // C++20 for the output columns
+#include <string_view> // For mode names
+#include <vector>    // For worker bookkeeping
+
+#include "normal_sampler.hpp"
+#include "philox.hpp"
+#include "retry_policy.hpp"
+#include "student.hpp"
+#include "student_table.hpp"
+#include "task_pool.hpp"
+
+// --- generate_single_student  ---
+constexpr NormalParams SCORE_DISTRIBUTION{.mean = SCORE_MEAN_CENTER,
+                                          .stddev = SCORE_STD_DEV};
+
+// How raw scores are drawn. RejectAndRetry samples the full normal and lets
+// out-of-range draws fail; TruncatedNormal samples the normal restricted to
+// [MIN_SCORE, MAX_SCORE] directly, so only injected errors ever retry.
+enum class GenerationMode : std::uint8_t { RejectAndRetry, TruncatedNormal };
+constexpr GenerationMode GENERATION_MODE = GenerationMode::TruncatedNormal;
+
+inline auto generation_mode_name(GenerationMode mode) -> std::string_view {
+  switch (mode) {
+  case GenerationMode::RejectAndRetry:
+    return "Normal Dist.";
+  case GenerationMode::TruncatedNormal:
+    return "Truncated Normal Dist.";
+  }
+  return "Unknown";
+}
+
+inline auto truncated_score_distribution() -> const TruncatedNormalParams & {
+  static const TruncatedNormalParams params =
+      make_truncated_normal(SCORE_DISTRIBUTION, MIN_SCORE, MAX_SCORE);
+  return params;
+}
+
+// Validate one raw draw; shared by the scalar and column paths below.
+inline auto check_generated_score(int student_id, double generated_score,
+                                  std::uint32_t error_word)
+    -> SingleStudentResult {
+  bool injected_error = (philox_below(error_word, 20) == 0);
+
+  if (injected_error) {
+    return std::unexpected(GenError{.raw_score = generated_score,
+                                    .student_id = student_id,
+                                    .code = GenErrorCode::SimulatedFailure});
+  }
+  if (generated_score < MIN_SCORE || generated_score > MAX_SCORE) {
+    return std::unexpected(GenError{.raw_score = generated_score,
+                                    .student_id = student_id,
+                                    .code = GenErrorCode::ScoreOutOfRange});
+  }
+  return Student{.id = student_id, .score = generated_score};
+}
+
+// Pure function of (seed, student_id, attempt): one Philox block keyed by the
+// seed with counter {id, attempt, 0, 0} supplies both Box-Muller uniforms and
+// the error-injection draw, so any attempt of any student can be recomputed
+// on its own in O(1) and from any thread.
+inline auto generate_single_student(int student_id, std::uint64_t seed,
+                                    std::uint32_t attempt,
+                                    GenerationMode mode)
+    -> SingleStudentResult {
+  const auto index = static_cast<std::uint32_t>(student_id);
+  const NormalDraw draw =
+      mode == GenerationMode::TruncatedNormal
+          ? sample_truncated_normal(truncated_score_distribution(), seed,
+                                    index, attempt)
+          : sample_normal(SCORE_DISTRIBUTION, seed, index, attempt);
+  return check_generated_score(student_id, draw.value, draw.spare_word);
+}
+
+// --- Batch Generation  ---
+constexpr size_t GENERATION_BLOCK = 256; // Rows sampled per column fill
+
+struct GenerationOptions {
+  std::uint64_t seed;
+  GenerationMode mode = GENERATION_MODE;
+  RetryPolicy retry_policy = make_immediate_retry();
+  TaskPool *pool = nullptr; // Null: shared_task_pool()
+};
+
+struct GenerationReport {
+  size_t students_generated = 0;
+  size_t total_attempts = 0;   // Includes the successful attempt per student
+  size_t deferred_retries = 0; // Retries that waited out a backoff
+  size_t workers_used = 0;
+};
+
+namespace generation_detail {
+
+// Generates one contiguous chunk. Failed rows whose policy asks for a backoff
+// are parked in a min-heap keyed by their ready time while the worker moves on
+// to the next block; parked rows are retried as they come due, and the worker
+// only waits once it has nothing else left to generate. That wait runs other
+// tasks of `pool` rather than sleeping.
+class ChunkWorker {
+public:
+  ChunkWorker(StudentTable &table, int first_id,
+              const GenerationOptions &options, TaskPool &pool)
+      : table_(table), first_id_(first_id), pool_(pool), options_(options),
+        key_(Philox4x32::key_from_seed(options.seed)) {}
+
+  void run(size_t begin, size_t end) {
+    for (size_t block = begin; block < end; block += GENERATION_BLOCK) {
+      generate_block(block, std::min(GENERATION_BLOCK, end - block));
+      retry_due(false);
+    }
+    retry_due(true);
+  }
+
+  size_t attempts = 0;
+  size_t deferred_retries = 0;
+  std::optional<GenError> exhausted; // Lowest id that ran out of attempts
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct PendingRetry {
+    Clock::time_point ready_at;
+    size_t row;
+    std::uint32_t attempt;
+  };
+  static constexpr auto LATER_FIRST = [](const PendingRetry &lhs,
+                                         const PendingRetry &rhs) {
+    return lhs.ready_at > rhs.ready_at;
+  };
+
+  auto id_of(size_t row) const -> int {
+    return first_id_ + static_cast<int>(row);
+  }
+
+  void generate_block(size_t block, size_t block_size) {
+    const auto scores = std::span(raw_scores_).first(block_size);
+    const auto words = std::span(error_words_).first(block_size);
+    const auto first_index = static_cast<std::uint32_t>(id_of(block));
+    if (options_.mode == GenerationMode::TruncatedNormal) {
+      fill_truncated_normal_column(scores, words,
+                                   truncated_score_distribution(),
+                                   options_.seed, first_index, 0);
+    } else {
+      fill_normal_column(scores, words, SCORE_DISTRIBUTION, options_.seed,
+                         first_index, 0);
+    }
+    for (size_t i = 0; i < block_size; ++i) {
+      attempts++;
+      settle(block + i, 0,
+             check_generated_score(id_of(block + i), scores[i], words[i]));
+    }
+  }
+
+  // Store a success, or retry inline / park / give up as the policy says.
+  void settle(size_t row, std::uint32_t attempt, SingleStudentResult result) {
+    const int target_id = id_of(row);
+    while (!result) {
+      const std::uint32_t jitter_word = Philox4x32::generate(
+          {static_cast<std::uint32_t>(target_id), attempt, 1, 0}, key_)[0];
+      const auto delay =
+          next_retry_delay(options_.retry_policy, attempt + 1, jitter_word);
+      if (!delay) {
+        if (!exhausted || target_id < exhausted->student_id) {
+          exhausted = GenError{.raw_score = result.error().raw_score,
+                               .student_id = target_id,
+                               .code = GenErrorCode::RetryBudgetExhausted};
+        }
+        return;
+      }
+      attempt++;
+      if (*delay > std::chrono::nanoseconds::zero()) {
+        pending_.push_back({Clock::now() + *delay, row, attempt});
+        std::ranges::push_heap(pending_, LATER_FIRST);
+        deferred_retries++;
+        return;
+      }
+      attempts++;
+      result = generate_single_student(target_id, options_.seed, attempt,
+                                       options_.mode);
+    }
+    table_.set_score(row, result->score); // The id is implicit in the row
+  }
+
+  void retry_due(bool wait_for_all) {
+    while (!pending_.empty()) {
+      const PendingRetry next = pending_.front();
+      if (next.ready_at > Clock::now()) {
+        if (!wait_for_all) {
+          return;
+        }
+        pool_.help_until(next.ready_at); // Nothing else left in this chunk
+      }
+      std::ranges::pop_heap(pending_, LATER_FIRST);
+      pending_.pop_back();
+      attempts++;
+      settle(next.row, next.attempt,
+             generate_single_student(id_of(next.row), options_.seed,
+                                     next.attempt, options_.mode));
+    }
+  }
+
+  StudentTable &table_;
+  int first_id_;
+  TaskPool &pool_;
+  const GenerationOptions &options_;
+  Philox4x32::Key key_;
+  std::array<double, GENERATION_BLOCK> raw_scores_{};
+  std::array<std::uint32_t, GENERATION_BLOCK> error_words_{};
+  std::vector<PendingRetry> pending_;
+};
+
+} // namespace generation_detail
+
+// Refill `table` (keeping its size) with students `first_id, first_id + 1,
+// ...`, whose ids are stored implicitly. Rows are split into one contiguous
+// chunk per thread of the task pool. Every attempt draws from its own
+// Philox counter, so the result for a given seed is bit-identical whatever the
+// worker count or retry timing. First attempts are sampled a column block at a
+// time; failed rows are retried as `options.retry_policy` directs. Fails if
+// any student exhausts its attempt budget.
+inline auto generate_students(StudentTable &table, int first_id,
+                              const GenerationOptions &options)
+    -> std::expected<GenerationReport, GenError> {
+  // Whole blocks per worker, so every row takes the same SIMD/scalar path
+  // whatever the worker count.
+  const size_t rows = table.size();
+  table = StudentTable(rows, first_id);
+  TaskPool &pool = options.pool ? *options.pool : shared_task_pool();
+  const size_t blocks = (rows + GENERATION_BLOCK - 1) / GENERATION_BLOCK;
+  // One chunk per thread rather than finer tasks: a chunk ends by waiting out
+  // its parked retries, and a whole chunk picked up by that wait would hold
+  // the retries past their ready time.
+  const size_t num_workers =
+      std::clamp<size_t>(pool.concurrency(), 1, std::max<size_t>(blocks, 1));
+  const size_t chunk_size =
+      (blocks + num_workers - 1) / num_workers * GENERATION_BLOCK;
+  std::vector<generation_detail::ChunkWorker> chunk_workers(
+      num_workers,
+      generation_detail::ChunkWorker(table, first_id, options, pool));
+
+  pool.parallel_for(num_workers, [&](size_t worker) {
+    const size_t begin = std::min(worker * chunk_size, rows);
+    chunk_workers[worker].run(begin, std::min(begin + chunk_size, rows));
+  });
+
+  GenerationReport report{.students_generated = rows,
+                          .workers_used = num_workers};
+  for (const auto &worker : chunk_workers) {
+    if (worker.exhausted) {
+      return std::unexpected(*worker.exhausted);
+    }
+    report.total_attempts += worker.attempts;
+    report.deferred_retries += worker.deferred_retries;
+  }
+  return report;
+}
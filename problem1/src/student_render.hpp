@@ -0,0 +1,66 @@
+#pragma once
+
+#include <algorithm>    // For std::copy, std::fill_n
+#include <array>        // For the row scratch buffer
+#include <charconv>     // For std::to_chars
+#include <cstddef>      // For size_t
+#include <format>       // For the fallback of oversized values
+#include <iterator>     // For std::back_inserter
+#include <string>       // For output buffers
+#include <system_error> // For std::errc
+
+#include "student.hpp"
+
+// --- Student table rows  ---
+// Column widths of the student tables the pipeline prints.
+constexpr int RENDER_ID_WIDTH = 10;
+constexpr int RENDER_SCORE_WIDTH = 12;
+// Bytes of a row whose values fit their columns, for reserving buffers.
+constexpr size_t RENDER_ROW_BYTES = RENDER_ID_WIDTH + RENDER_SCORE_WIDTH + 8;
+
+namespace student_render_detail {
+
+// Copies [first, last) to `out` and pads it with spaces to `width`.
+inline auto put_padded(char *out, const char *first, const char *last,
+                       int width) -> char * {
+  out = std::copy(first, last, out);
+  const auto length = static_cast<int>(last - first);
+  return length < width ? std::fill_n(out, width - length, ' ') : out;
+}
+
+} // namespace student_render_detail
+
+// Appends the table row of `student`: the same text as
+//   std::format("| {:<10} | {:<12.2f} |\n", student.id, student.score)
+// built with std::to_chars into a stack buffer, so no format string is
+// parsed per row. Scores too large for the buffer take the std::format path.
+inline void append_student_row(std::string &text, const Student &student) {
+  using student_render_detail::put_padded;
+  std::array<char, 24> id{};
+  std::array<char, 48> score{};
+  const auto id_end = std::to_chars(id.data(), id.data() + id.size(),
+                                    student.id);
+  const auto score_end =
+      std::to_chars(score.data(), score.data() + score.size(), student.score,
+                    std::chars_format::fixed, 2);
+  if (score_end.ec != std::errc{}) {
+    std::format_to(std::back_inserter(text), "| {:<{}} | {:<{}.2f} |\n",
+                   student.id, RENDER_ID_WIDTH, student.score,
+                   RENDER_SCORE_WIDTH);
+    return;
+  }
+
+  std::array<char, id.size() + score.size() + RENDER_ROW_BYTES> row{};
+  char *out = row.data();
+  *out++ = '|';
+  *out++ = ' ';
+  out = put_padded(out, id.data(), id_end.ptr, RENDER_ID_WIDTH);
+  *out++ = ' ';
+  *out++ = '|';
+  *out++ = ' ';
+  out = put_padded(out, score.data(), score_end.ptr, RENDER_SCORE_WIDTH);
+  *out++ = ' ';
+  *out++ = '|';
+  *out++ = '\n';
+  text.append(row.data(), out);
+}
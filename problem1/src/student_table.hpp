@@ -0,0 +1,572 @@
+#pragma once
+
+#include <algorithm> // For std::min, std::ranges::sort
+#include <atomic>    // For std::atomic_ref dirty-block marks
+#include <cstddef>   // For size_t, std::ptrdiff_t
+#include <cstdint>   // For RowIndex, dirty-block flags
+#include <mutex>     // For publishing the cached score order
+#include <numeric>   // For std::iota
+#include <optional>  // For order-aware filter ranges
+#include <ranges>    // For the row view
+#include <span>      // C++20 for column views
+#include <utility>   // For std::move
+#include <vector>    // For column storage
+
+#include "score_codec.hpp"
+#include "score_filter.hpp"
+#include "score_reduce.hpp"
+#include "score_sort.hpp"
+#include "student.hpp"
+#include "task_pool.hpp"
+
+// What a table knows about the order of its rows by score. Descending means
+// every score is at most the one before it; Unknown promises nothing.
+enum class ScoreOrdering : std::uint8_t { Unknown, Descending };
+
+// Rows [begin, end) of a table.
+struct RowRange {
+  size_t begin = 0;
+  size_t end = 0;
+};
+
+// Result of BasicStudentTable::scan_scores: one selection per predicate, in
+// the order given, and the summary of all scores.
+struct ScoreScan {
+  std::vector<SelectionVector> selections;
+  ScoreSummary summary;
+};
+
+// --- BasicStudentTable  ---
+// Column store for student data: ids and scores live in separate contiguous
+// arrays, so scans that only need scores (filters, averages) stream half the
+// bytes of a std::vector<Student> and vectorize cleanly. rows() presents the
+// table as a StudentRange of Student values for code that wants whole rows.
+//
+// Ids start out implicit: while row r holds id `id_base + r` no id column is
+// stored at all, and a row position is its id. The column is materialized
+// only when a sort, an erase or an out-of-sequence append breaks that rule.
+//
+// Scores are stored through `Codec` (see score_codec.hpp). Row access decodes
+// to double; threshold filters and sums work on the stored values directly.
+//
+// The table maintains a ScoreSummary of its scores: one StoredScoreSummary per
+// block of SUMMARY_BLOCK_ROWS rows plus their total. Appends fold into the
+// last block as they go; set_score only marks its block dirty, and
+// refresh_score_summary re-summarizes the dirty blocks alone. Reading the
+// summary of a clean table is O(1).
+//
+// It also caches the descending score order (see descending_order) from the
+// first time a reader asks until the next change to the table, and records
+// whether the rows themselves are in that order (score_ordering): the sort
+// establishes it, appends in order and erasures keep it, and any other write
+// drops it. set_score drops it through the dirty summary block it marks
+// anyway, so the per-row write path pays nothing extra. While the ordering
+// holds, threshold filters binary-search the score column for the one
+// contiguous run of matching rows instead of scanning it; while only the
+// cached order is there, they binary-search that permutation instead and,
+// when few rows match, list them from it without a scan.
+template <typename Codec> class BasicStudentTable {
+public:
+  using ScoreCodec = Codec;
+  using StoredScore = typename Codec::Stored;
+
+  BasicStudentTable() = default;
+  // `count` rows with dense ids first_id, first_id + 1, ... and zero scores.
+  BasicStudentTable(size_t count, int first_id)
+      : id_base_(first_id), scores_(count, Codec::encode(0.0)) {
+    rebuild_score_summary();
+  }
+
+  [[nodiscard]] auto size() const -> size_t { return scores_.size(); }
+  [[nodiscard]] auto empty() const -> bool { return scores_.empty(); }
+
+  [[nodiscard]] auto has_implicit_ids() const -> bool { return implicit_ids_; }
+  [[nodiscard]] auto id_at(size_t row) const -> int {
+    return implicit_ids_ ? id_base_ + static_cast<int>(row) : ids_[row];
+  }
+  [[nodiscard]] auto score_at(size_t row) const -> double {
+    return Codec::decode(scores_[row]);
+  }
+  // The score column in its stored encoding.
+  [[nodiscard]] auto stored_scores() const -> std::span<const StoredScore> {
+    return scores_;
+  }
+  // Bytes held per row by the columns as currently stored.
+  [[nodiscard]] auto bytes_per_row() const -> size_t {
+    return sizeof(StoredScore) + (implicit_ids_ ? 0 : sizeof(int));
+  }
+
+  // Overwrite one score in place. For bulk producers such as the generator:
+  // distinct rows may be written from different threads. The row's summary
+  // block is marked dirty; see refresh_score_summary.
+  void set_score(size_t row, double score) {
+    scores_[row] = Codec::encode(score);
+    mark_block_dirty(row / SUMMARY_BLOCK_ROWS);
+    if (score_order_.valid.load(std::memory_order_relaxed)) {
+      score_order_.valid.store(false, std::memory_order_relaxed);
+    }
+  }
+
+  [[nodiscard]] auto operator[](size_t row) const -> Student {
+    return {.id = id_at(row), .score = score_at(row)};
+  }
+
+  void reserve(size_t count) {
+    scores_.reserve(count);
+    if (!implicit_ids_) {
+      ids_.reserve(count);
+    }
+  }
+  void push_back(const Student &student) {
+    if (implicit_ids_ && empty()) {
+      id_base_ = student.id;
+    } else if (implicit_ids_ && student.id != id_at(size())) {
+      materialize_ids();
+    }
+    if (!implicit_ids_) {
+      ids_.push_back(student.id);
+    }
+    const StoredScore stored = Codec::encode(student.score);
+    if (!empty() && stored > scores_.back()) {
+      score_ordering_ = ScoreOrdering::Unknown;
+    }
+    scores_.push_back(stored);
+    score_order_.valid.store(false, std::memory_order_relaxed);
+    if (block_summaries_.size() * SUMMARY_BLOCK_ROWS < size()) {
+      block_summaries_.emplace_back();
+      dirty_blocks_.push_back(0);
+    }
+    block_summaries_.back().add(stored);
+    summary_.add(stored);
+  }
+
+  // Rows in storage order, as Student values.
+  [[nodiscard]] auto rows() const {
+    return std::views::iota(size_t{0}, size()) |
+           std::views::transform([this](size_t row) { return (*this)[row]; });
+  }
+
+  // Rows at the given positions, in the order given.
+  [[nodiscard]] auto rows(std::span<const RowIndex> positions) const {
+    return positions |
+           std::views::transform([this](RowIndex row) { return (*this)[row]; });
+  }
+
+  // Positions of the rows satisfying `predicate`, in storage order. With
+  // implicit ids each position maps back to its id without a lookup.
+  template <typename Predicate>
+  [[nodiscard]] auto positions_where(Predicate predicate) const
+      -> SelectionVector {
+    SelectionVector positions;
+    for (size_t row = 0; row < size(); ++row) {
+      if (predicate((*this)[row])) {
+        positions.push_back(static_cast<RowIndex>(row));
+      }
+    }
+    return positions;
+  }
+
+  // Same, for a score threshold: the threshold is translated once into the
+  // stored domain and the score column is scanned by the SIMD kernels in
+  // score_filter.hpp, never decoding a row. Skips the scan when
+  // listed_positions_where can do without it.
+  [[nodiscard]] auto positions_where(ScorePredicate predicate) const
+      -> SelectionVector {
+    if (auto positions = listed_positions_where(predicate)) {
+      return std::move(*positions);
+    }
+    return select_scores(stored_scores(), predicate.comparison,
+                         stored_cutoff(predicate));
+  }
+
+  // positions_where without the scan: the run sorted_rows_where finds in a
+  // table sorted by score, or else the rows ordered_rows_where finds in the
+  // cached order put back in storage order, if they are few enough that
+  // sorting them beats scanning the column. nullopt when only a scan will do.
+  [[nodiscard]] auto listed_positions_where(ScorePredicate predicate) const
+      -> std::optional<SelectionVector> {
+    if (const auto range = sorted_rows_where(predicate)) {
+      SelectionVector positions(range->end - range->begin);
+      std::iota(positions.begin(), positions.end(),
+                static_cast<RowIndex>(range->begin));
+      return positions;
+    }
+    const auto rows = ordered_rows_where(predicate);
+    if (!rows || rows->size() > size() / LISTED_SELECTION_RATIO) {
+      return std::nullopt;
+    }
+    SelectionVector positions(rows->begin(), rows->end());
+    std::ranges::sort(positions);
+    return positions;
+  }
+
+  // A dirty summary block means set_score has written since the ordering was
+  // last known, which drops it.
+  [[nodiscard]] auto score_ordering() const -> ScoreOrdering {
+    return dirty_block_count_ == 0 ? score_ordering_ : ScoreOrdering::Unknown;
+  }
+
+  // The rows satisfying `predicate`, as one contiguous range found by binary
+  // search in O(log n), if the table is sorted by score; nullopt otherwise.
+  // Descending scores put the rows above a threshold first and the rows
+  // below it last.
+  [[nodiscard]] auto sorted_rows_where(ScorePredicate predicate) const
+      -> std::optional<RowRange> {
+    if (score_ordering() != ScoreOrdering::Descending) {
+      return std::nullopt;
+    }
+    const auto cutoff = stored_cutoff(predicate);
+    const bool leading = selects_leading(predicate);
+    const auto split = std::ranges::partition_point(
+        scores_, [&](StoredScore stored) {
+          return stored_score_matches(stored, predicate.comparison, cutoff) ==
+                 leading;
+        });
+    const auto split_row = static_cast<size_t>(split - scores_.begin());
+    return leading ? RowRange{.begin = 0, .end = split_row}
+                   : RowRange{.begin = split_row, .end = size()};
+  }
+
+  // The rows satisfying `predicate`, best score first, as the prefix or
+  // suffix of the cached descending_order found by binary search over the
+  // permuted scores, if the order is cached; nullopt otherwise. The span
+  // points into the cache and is valid until the table next changes.
+  [[nodiscard]] auto ordered_rows_where(ScorePredicate predicate) const
+      -> std::optional<std::span<const RowIndex>> {
+    if (!score_order_.valid.load(std::memory_order_acquire)) {
+      return std::nullopt;
+    }
+    const std::span<const RowIndex> order = score_order_.order;
+    const auto cutoff = stored_cutoff(predicate);
+    const bool leading = selects_leading(predicate);
+    const auto split =
+        std::ranges::partition_point(order, [&](RowIndex row) {
+          return stored_score_matches(scores_[row], predicate.comparison,
+                                      cutoff) == leading;
+        });
+    const auto split_at = static_cast<size_t>(split - order.begin());
+    return leading ? order.first(split_at) : order.subspan(split_at);
+  }
+
+  // Result of scan_score_range. The summary stays in the codec's domain, so
+  // partial scans of adjacent ranges combine without loss.
+  struct PartialScoreScan {
+    std::vector<SelectionVector> selections;
+    StoredScoreSummary<Codec> summary{};
+  };
+
+  // Every selection in `predicates` plus, if `summarize` is set, the score
+  // summary, from one pass over the score column: each slice small enough to
+  // stay in L1 is run through all the filter kernels and the reduction before
+  // the next one is loaded. Without `summarize` the summary is left empty.
+  // Selections listed_positions_where can make are left out of the pass.
+  [[nodiscard]] auto scan_scores(std::span<const ScorePredicate> predicates,
+                                 bool summarize = true) const -> ScoreScan {
+    return scan_unlisted(
+        predicates, summarize,
+        [&](std::span<const ScorePredicate> unlisted) -> ScoreScan {
+          PartialScoreScan scan =
+              scan_score_range(unlisted, 0, size(), summarize);
+          return {.selections = std::move(scan.selections),
+                  .summary = scan.summary.decode()};
+        });
+  }
+
+  // Takes the selections listed_positions_where can make out of
+  // `predicates`, hands the rest to `scan` (a pass over the column returning
+  // their selections in order, plus the summary if `summarize` is set) and
+  // returns all of them in the order given. With nothing left to select and
+  // no summary wanted, `scan` is not called at all.
+  template <typename Scan>
+  [[nodiscard]] auto scan_unlisted(std::span<const ScorePredicate> predicates,
+                                   bool summarize, Scan scan) const
+      -> ScoreScan {
+    std::vector<std::optional<SelectionVector>> listed(predicates.size());
+    std::vector<ScorePredicate> unlisted;
+    for (size_t i = 0; i < predicates.size(); ++i) {
+      listed[i] = listed_positions_where(predicates[i]);
+      if (!listed[i]) {
+        unlisted.push_back(predicates[i]);
+      }
+    }
+    ScoreScan scanned;
+    if (!unlisted.empty() || summarize) {
+      scanned = scan(std::span<const ScorePredicate>(unlisted));
+    }
+    ScoreScan result{.selections =
+                         std::vector<SelectionVector>(predicates.size()),
+                     .summary = scanned.summary};
+    size_t next_scanned = 0;
+    for (size_t i = 0; i < predicates.size(); ++i) {
+      result.selections[i] =
+          listed[i] ? std::move(*listed[i])
+                    : std::move(scanned.selections[next_scanned++]);
+    }
+    return result;
+  }
+
+  // One pass of scan_scores restricted to rows [begin, end), with every
+  // predicate scanned; positions are still table rows.
+  [[nodiscard]] auto
+  scan_score_range(std::span<const ScorePredicate> predicates, size_t begin,
+                   size_t end, bool summarize = true) const
+      -> PartialScoreScan {
+    PartialScoreScan scan{.selections =
+                              std::vector<SelectionVector>(predicates.size())};
+    const std::span<const StoredScore> column = stored_scores();
+    for (size_t first = begin; first < end; first += SCAN_SLICE_ROWS) {
+      const auto slice =
+          column.subspan(first, std::min(SCAN_SLICE_ROWS, end - first));
+      for (size_t i = 0; i < predicates.size(); ++i) {
+        append_selected_scores(slice, static_cast<RowIndex>(first),
+                               predicates[i].comparison,
+                               stored_cutoff(predicates[i]),
+                               scan.selections[i]);
+      }
+      if (summarize) {
+        scan.summary.merge(summarize_stored_scores<Codec>(slice));
+      }
+    }
+    return scan;
+  }
+
+  // Count, sum, sum of squares and range of all scores, reduced in the
+  // codec's own domain (exact integers for fixed point, compensated sums for
+  // floating point) and decoded once at the end.
+  [[nodiscard]] auto summarize_scores() const -> ScoreSummary {
+    return summarize_stored_scores<Codec>(stored_scores()).decode();
+  }
+  [[nodiscard]] auto sum_scores() const -> double {
+    return summarize_scores().sum;
+  }
+
+  // The maintained summary of all scores. O(1) unless set_score has dirtied
+  // blocks since the last refresh, in which case those blocks are summarized
+  // afresh for this call (and only those).
+  [[nodiscard]] auto score_summary() const -> ScoreSummary {
+    if (dirty_block_count_ == 0) {
+      return summary_.decode();
+    }
+    StoredScoreSummary<Codec> total{};
+    for (size_t block = 0; block < block_summaries_.size(); ++block) {
+      total.merge(dirty_blocks_[block] != 0 ? summarize_block(block)
+                                            : block_summaries_[block]);
+    }
+    return total.decode();
+  }
+
+  // Re-summarize the blocks set_score dirtied and re-total, so score_summary
+  // is O(1) again. Not thread-safe: call it while no one else uses the table.
+  void refresh_score_summary() {
+    if (dirty_block_count_ == 0) {
+      return;
+    }
+    score_ordering_ = ScoreOrdering::Unknown; // See score_ordering
+    for (size_t block = 0; block < block_summaries_.size(); ++block) {
+      if (dirty_blocks_[block] != 0) {
+        block_summaries_[block] = summarize_block(block);
+        dirty_blocks_[block] = 0;
+      }
+    }
+    dirty_block_count_ = 0;
+    total_score_summary();
+  }
+
+  // Mean, variance and range of the scores in rows [begin, end), in one
+  // Welford pass.
+  [[nodiscard]] auto score_statistics(size_t begin, size_t end) const
+      -> ScoreStatistics {
+    return accumulate_score_statistics<Codec>(
+        stored_scores().subspan(begin, end - begin));
+  }
+  [[nodiscard]] auto score_statistics() const -> ScoreStatistics {
+    return score_statistics(0, size());
+  }
+
+  // Reorder both columns by descending score, ties in storage order. Sorts a
+  // row permutation on the stored score column alone (every codec is
+  // monotonic), with a parallel radix sort on `pool` for large tables, then
+  // gathers each column once.
+  void sort_by_score_descending(TaskPool &pool = shared_task_pool()) {
+    apply_permutation(sort_positions_descending(stored_scores(), pool));
+    score_ordering_ = ScoreOrdering::Descending;
+  }
+
+  // Positions of every row by descending score, ties in storage order: the
+  // permutation sort_by_score_descending would apply, leaving the rows where
+  // they are. Computed on first use and cached until the table changes, so
+  // repeat calls are free. Safe to call from concurrent readers; if two race
+  // on an empty cache both sort and one result is kept.
+  [[nodiscard]] auto
+  descending_order(TaskPool &pool = shared_task_pool()) const
+      -> const SelectionVector & {
+    if (!score_order_.valid.load(std::memory_order_acquire)) {
+      // Sorted outside the lock: the sort waits on the pool, and a waiting
+      // thread may pick up another reader's task that asks for the order.
+      SelectionVector order = sort_positions_descending(stored_scores(), pool);
+      const std::scoped_lock lock(score_order_.mutex);
+      if (!score_order_.valid.load(std::memory_order_relaxed)) {
+        score_order_.order = std::move(order);
+        score_order_.valid.store(true, std::memory_order_release);
+      }
+    }
+    return score_order_.order;
+  }
+
+  // Positions of the `k` highest-scoring rows, best first, ties in storage
+  // order: the head of descending_order. Read from the cached order when
+  // there is one, otherwise selected without sorting the rest.
+  [[nodiscard]] auto top_positions(size_t k,
+                                   TaskPool &pool = shared_task_pool()) const
+      -> SelectionVector {
+    if (score_order_.valid.load(std::memory_order_acquire)) {
+      const SelectionVector &order = score_order_.order;
+      return {order.begin(),
+              order.begin() +
+                  static_cast<std::ptrdiff_t>(std::min(k, order.size()))};
+    }
+    return top_k_descending(stored_scores(), k, pool);
+  }
+
+  // Remove the rows satisfying `predicate`, keeping the others in order.
+  template <typename Predicate> auto erase_if(Predicate predicate) -> size_t {
+    const SelectionVector doomed = positions_where(predicate);
+    if (doomed.empty()) {
+      return 0;
+    }
+    materialize_ids();
+    size_t kept = 0;
+    size_t next_doomed = 0;
+    for (size_t row = 0; row < size(); ++row) {
+      if (next_doomed < doomed.size() && doomed[next_doomed] == row) {
+        next_doomed++;
+        continue;
+      }
+      ids_[kept] = ids_[row];
+      scores_[kept] = scores_[row];
+      kept++;
+    }
+    ids_.resize(kept);
+    scores_.resize(kept);
+    rebuild_score_summary();
+    score_order_.valid.store(false, std::memory_order_relaxed);
+    return doomed.size();
+  }
+
+private:
+  // The cached descending_order. A copy of the table starts without one.
+  struct ScoreOrderCache {
+    ScoreOrderCache() = default;
+    ScoreOrderCache(const ScoreOrderCache & /*other*/) {}
+    auto operator=(const ScoreOrderCache & /*other*/) -> ScoreOrderCache & {
+      valid.store(false, std::memory_order_relaxed);
+      return *this;
+    }
+    ~ScoreOrderCache() = default;
+
+    std::mutex mutex; // Held only to publish `order`
+    SelectionVector order;
+    std::atomic<bool> valid{false};
+  };
+
+  static constexpr size_t SCAN_SLICE_ROWS = 16384 / sizeof(StoredScore);
+  // listed_positions_where sorts rows from the cached order only while they
+  // are at most 1 / LISTED_SELECTION_RATIO of the table
+  static constexpr size_t LISTED_SELECTION_RATIO = 64;
+  static constexpr size_t SUMMARY_BLOCK_ROWS = 4096;
+
+  // The threshold of `predicate` translated into the stored domain.
+  static auto stored_cutoff(ScorePredicate predicate) ->
+      typename Codec::Cutoff {
+    const bool rounds_down =
+        predicate.comparison == ScoreComparison::Greater ||
+        predicate.comparison == ScoreComparison::LessEqual;
+    return rounds_down ? Codec::floor_cutoff(predicate.threshold)
+                       : Codec::ceil_cutoff(predicate.threshold);
+  }
+
+  // Whether rows satisfying `predicate` come first in descending order.
+  static auto selects_leading(ScorePredicate predicate) -> bool {
+    return predicate.comparison == ScoreComparison::Greater ||
+           predicate.comparison == ScoreComparison::GreaterEqual;
+  }
+
+  void materialize_ids() {
+    if (!implicit_ids_) {
+      return;
+    }
+    ids_.resize(size());
+    std::iota(ids_.begin(), ids_.end(), id_base_);
+    implicit_ids_ = false;
+  }
+
+  void apply_permutation(std::span<const RowIndex> order) {
+    std::vector<int> ids(order.size());
+    std::vector<StoredScore> scores(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+      ids[i] = id_at(order[i]);
+      scores[i] = scores_[order[i]];
+    }
+    ids_ = std::move(ids);
+    scores_ = std::move(scores);
+    implicit_ids_ = false;
+    rebuild_score_summary();
+    score_order_.valid.store(false, std::memory_order_relaxed);
+  }
+
+  // --- Maintained score summary  ---
+  [[nodiscard]] auto summarize_block(size_t block) const
+      -> StoredScoreSummary<Codec> {
+    const size_t begin = block * SUMMARY_BLOCK_ROWS;
+    return summarize_stored_scores<Codec>(stored_scores().subspan(
+        begin, std::min(SUMMARY_BLOCK_ROWS, size() - begin)));
+  }
+
+  // Several set_score calls may race to mark the same block; only the one
+  // that sets the flag counts it.
+  void mark_block_dirty(size_t block) {
+    std::atomic_ref<std::uint8_t> flag(dirty_blocks_[block]);
+    if (flag.load(std::memory_order_relaxed) == 0 &&
+        flag.exchange(1, std::memory_order_relaxed) == 0) {
+      std::atomic_ref<size_t>(dirty_block_count_)
+          .fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  void total_score_summary() {
+    summary_ = {};
+    for (const auto &block : block_summaries_) {
+      summary_.merge(block);
+    }
+  }
+
+  void rebuild_score_summary() {
+    if (dirty_block_count_ != 0) {
+      score_ordering_ = ScoreOrdering::Unknown; // See score_ordering
+    }
+    const size_t blocks =
+        (size() + SUMMARY_BLOCK_ROWS - 1) / SUMMARY_BLOCK_ROWS;
+    block_summaries_.resize(blocks);
+    dirty_blocks_.assign(blocks, 0);
+    dirty_block_count_ = 0;
+    for (size_t block = 0; block < blocks; ++block) {
+      block_summaries_[block] = summarize_block(block);
+    }
+    total_score_summary();
+  }
+
+  bool implicit_ids_ = true;
+  int id_base_ = 1;
+  std::vector<int> ids_; // Empty while ids are implicit
+  std::vector<StoredScore> scores_;
+  std::vector<StoredScoreSummary<Codec>> block_summaries_;
+  std::vector<std::uint8_t> dirty_blocks_; // Non-zero: summary is stale
+  size_t dirty_block_count_ = 0;
+  StoredScoreSummary<Codec> summary_{}; // Total of block_summaries_
+  // A new table's scores are all equal, so already in order
+  ScoreOrdering score_ordering_ = ScoreOrdering::Descending;
+  mutable ScoreOrderCache score_order_;
+};
+
+// The table the program uses, with the score encoding chosen by SCORE_STORAGE.
+using StudentTable = BasicStudentTable<ScoreCodecFor<SCORE_STORAGE>>;
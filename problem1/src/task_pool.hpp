@@ -0,0 +1,244 @@
+#pragma once
+
+#include <algorithm>  // For std::max, std::min
+#include <atomic>     // For pending counts and the wake-up epochs
+#include <chrono>     // For help_until deadlines
+#include <cstddef>    // For size_t
+#include <cstdint>    // For the epoch counter
+#include <deque>      // For per-worker task deques
+#include <functional> // For std::function tasks
+#include <memory>     // For std::unique_ptr queues
+#include <mutex>      // For deque locks
+#include <optional>   // For the result of a pop
+#include <thread>     // For std::jthread workers
+#include <utility>    // For std::move
+#include <vector>     // For workers and queues
+
+#if defined(__linux__)
+#include <pthread.h> // For pthread_setaffinity_np
+#include <sched.h>   // For cpu_set_t
+#endif
+
+inline auto default_worker_count() -> size_t {
+  return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+// --- TaskGroup  ---
+// Counts the tasks submitted under it that have not finished yet; see
+// TaskPool::wait. Nothing waits on the group itself, so it may be destroyed
+// as soon as wait() returns.
+class TaskGroup {
+public:
+  TaskGroup() = default;
+  TaskGroup(const TaskGroup &) = delete;
+  auto operator=(const TaskGroup &) -> TaskGroup & = delete;
+
+private:
+  friend class TaskPool;
+  std::atomic<size_t> pending_{0};
+};
+
+struct TaskPoolOptions {
+  // Threads besides the caller; whoever waits on a TaskGroup runs tasks too.
+  size_t num_workers = default_worker_count() - 1;
+  // Linux only: pin worker i to CPU (i + 1) mod the CPU count, leaving CPU 0
+  // to the main thread. Ignored elsewhere.
+  bool pin_workers = false;
+};
+
+// --- TaskPool  ---
+// Work-stealing scheduler. Every worker owns a deque: tasks it submits itself
+// go to the back and it pops from the back (newest first, still in cache),
+// while idle workers steal from the front of the others (oldest first, the
+// largest remaining pieces). Tasks from threads outside the pool go to a
+// shared injection queue. Idle workers sleep on an epoch counter that every
+// submission bumps; threads in wait() sleep on one that every group's last
+// task bumps once it is done with the group.
+//
+// Tasks must not throw; failures travel back in their results.
+class TaskPool {
+public:
+  using Task = std::function<void()>;
+
+  explicit TaskPool(TaskPoolOptions options = {}) {
+    for (size_t i = 0; i <= options.num_workers; ++i) {
+      queues_.push_back(std::make_unique<TaskQueue>()); // Last: injection
+    }
+    workers_.reserve(options.num_workers);
+    for (size_t i = 0; i < options.num_workers; ++i) {
+      workers_.emplace_back([this, i, pin = options.pin_workers] {
+        if (pin) {
+          pin_current_thread(i + 1);
+        }
+        worker_loop(i);
+      });
+    }
+  }
+
+  TaskPool(const TaskPool &) = delete;
+  auto operator=(const TaskPool &) -> TaskPool & = delete;
+
+  ~TaskPool() {
+    stopping_.store(true, std::memory_order_release);
+    work_epoch_.fetch_add(1, std::memory_order_release);
+    work_epoch_.notify_all();
+    workers_.clear(); // jthreads join here
+  }
+
+  [[nodiscard]] auto worker_count() const -> size_t { return workers_.size(); }
+  // Threads that take part in a parallel_for: the workers plus the caller.
+  [[nodiscard]] auto concurrency() const -> size_t {
+    return workers_.size() + 1;
+  }
+
+  void submit(TaskGroup &group, Task task) {
+    group.pending_.fetch_add(1, std::memory_order_relaxed);
+    TaskQueue &queue =
+        *queues_[current_pool == this ? current_worker : injection_index()];
+    {
+      const std::scoped_lock lock(queue.mutex);
+      queue.tasks.push_back({.task = std::move(task), .group = &group});
+    }
+    work_epoch_.fetch_add(1, std::memory_order_release);
+    work_epoch_.notify_one();
+  }
+
+  // Returns once every task submitted under `group` has finished. The waiting
+  // thread runs queued tasks (of any group) in the meantime, so waiting from
+  // inside a task cannot starve the pool.
+  void wait(TaskGroup &group) {
+    const size_t self =
+        current_pool == this ? current_worker : injection_index();
+    while (true) {
+      // Read before the count: a group finishing after the check below bumps
+      // the epoch past this value, so the wait cannot miss it.
+      const std::uint64_t epoch = done_epoch_.load(std::memory_order_acquire);
+      if (group.pending_.load(std::memory_order_acquire) == 0) {
+        return;
+      }
+      if (!try_run_one(self)) {
+        done_epoch_.wait(epoch, std::memory_order_acquire);
+      }
+    }
+  }
+
+  // Returns at `deadline`, running queued tasks (of any group) until then: for
+  // a task that has to wait on the clock rather than on other tasks. With
+  // nothing queued the thread sleeps in slices of HELP_POLL_INTERVAL, looking
+  // for new work between them. A task started here may run past `deadline`.
+  void help_until(std::chrono::steady_clock::time_point deadline) {
+    const size_t self =
+        current_pool == this ? current_worker : injection_index();
+    while (std::chrono::steady_clock::now() < deadline) {
+      if (!try_run_one(self)) {
+        std::this_thread::sleep_until(std::min(
+            deadline, std::chrono::steady_clock::now() + HELP_POLL_INTERVAL));
+      }
+    }
+  }
+
+  // body(i) for every i in [0, count), spread across the pool; returns when
+  // all are done.
+  template <typename Body> void parallel_for(size_t count, Body body) {
+    TaskGroup group;
+    for (size_t i = 0; i < count; ++i) {
+      submit(group, [&body, i] { body(i); });
+    }
+    wait(group);
+  }
+
+private:
+  struct QueuedTask {
+    Task task;
+    TaskGroup *group;
+  };
+  struct TaskQueue {
+    std::mutex mutex;
+    std::deque<QueuedTask> tasks;
+  };
+
+  static constexpr auto HELP_POLL_INTERVAL = std::chrono::microseconds(200);
+
+  static inline thread_local const TaskPool *current_pool = nullptr;
+  static inline thread_local size_t current_worker = 0;
+
+  [[nodiscard]] auto injection_index() const -> size_t {
+    return queues_.size() - 1;
+  }
+
+  static void pin_current_thread([[maybe_unused]] size_t cpu) {
+#if defined(__linux__)
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu % default_worker_count(), &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+#endif
+  }
+
+  // A worker pops its own deque from the back, then takes from the front of
+  // the injection queue and of the other workers' deques. A thread outside
+  // the pool only does the latter.
+  auto try_run_one(size_t self) -> bool {
+    const bool is_worker = self != injection_index();
+    std::optional<QueuedTask> found;
+    if (is_worker) {
+      found = pop(*queues_[self], false);
+    }
+    for (size_t offset = 0; !found && offset < queues_.size(); ++offset) {
+      const size_t victim = (injection_index() + offset) % queues_.size();
+      if (!is_worker || victim != self) {
+        found = pop(*queues_[victim], true);
+      }
+    }
+    if (!found) {
+      return false;
+    }
+    found->task();
+    // The group may be gone once its count reaches zero (its waiter can see
+    // the zero and return at once), so the wake-up goes through the pool.
+    if (found->group->pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      done_epoch_.fetch_add(1, std::memory_order_release);
+      done_epoch_.notify_all();
+    }
+    return true;
+  }
+
+  static auto pop(TaskQueue &queue, bool from_front)
+      -> std::optional<QueuedTask> {
+    const std::scoped_lock lock(queue.mutex);
+    if (queue.tasks.empty()) {
+      return std::nullopt;
+    }
+    QueuedTask task = std::move(from_front ? queue.tasks.front()
+                                           : queue.tasks.back());
+    if (from_front) {
+      queue.tasks.pop_front();
+    } else {
+      queue.tasks.pop_back();
+    }
+    return task;
+  }
+
+  void worker_loop(size_t index) {
+    current_pool = this;
+    current_worker = index;
+    while (!stopping_.load(std::memory_order_acquire)) {
+      const std::uint64_t epoch = work_epoch_.load(std::memory_order_acquire);
+      if (!try_run_one(index)) {
+        work_epoch_.wait(epoch, std::memory_order_acquire);
+      }
+    }
+  }
+
+  std::vector<std::unique_ptr<TaskQueue>> queues_;
+  std::atomic<std::uint64_t> work_epoch_{0};
+  std::atomic<std::uint64_t> done_epoch_{0}; // Bumped as each group finishes
+  std::atomic<bool> stopping_{false};
+  std::vector<std::jthread> workers_; // Last: started once the rest exists
+};
+
+// Process-wide pool with default options, created on first use.
+inline auto shared_task_pool() -> TaskPool & {
+  static TaskPool pool;
+  return pool;
+}
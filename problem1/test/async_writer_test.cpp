@@ -0,0 +1,212 @@
+// AsyncWriter with a ring of two slots and many more blocks than that:
+//  - blocks come out complete and in the order they were written, and the
+//    destructor writes out whatever is still queued;
+//  - flush() returns only once every queued block has reached the FILE;
+//  - (POSIX) while the FILE cannot take more bytes, write() stops once the
+//    ring fills, or once the queued text reaches the byte limit, rather
+//    than queuing without bound, and resumes in order once the reader
+//    catches up.
+// Exits non-zero on the first failed check. Worth running under
+// -fsanitize=thread as well.
+//
+//   clang++ -std=c++23 -O2 -pthread -I../src async_writer_test.cpp
+#include <atomic>     // For the producer's progress counter
+#include <chrono>     // For polling the producer's progress
+#include <cstddef>    // For size_t
+#include <cstdio>     // For temporary files and pipes
+#include <filesystem> // For the flush test's file
+#include <format>     // For numbered blocks
+#include <print>      // C++23 printing
+#include <string>     // For blocks and file contents
+#include <thread>     // For the producer and reader threads
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h> // For ::pipe, ::read, ::close
+#define ASYNC_WRITER_TEST_PIPE 1
+#endif
+
+#include "async_writer.hpp"
+
+constexpr size_t RING_CAPACITY = 2;
+constexpr size_t NUM_BLOCKS = 10000;
+
+// Block `index`: its number and a tail whose length varies with it.
+auto numbered_block(size_t index) -> std::string {
+  return std::format("{}:{}\n", index, std::string(index % 97, 'x'));
+}
+
+auto expected_text(size_t blocks) -> std::string {
+  std::string text;
+  for (size_t i = 0; i < blocks; ++i) {
+    text += numbered_block(i);
+  }
+  return text;
+}
+
+// Everything in `file`, read from the start.
+auto file_contents(std::FILE *file) -> std::string {
+  std::rewind(file);
+  std::string text;
+  std::string buffer(4096, '\0');
+  size_t read = 0;
+  while ((read = std::fread(buffer.data(), 1, buffer.size(), file)) > 0) {
+    text.append(buffer.data(), read);
+  }
+  return text;
+}
+
+// Whether `counter` reaches `expected` within a generous timeout and then
+// stays there for a while. Polls rather than sleeping a fixed time, so a slow
+// machine cannot fail the check, only take longer over it.
+auto settles_at(const std::atomic<size_t> &counter, size_t expected) -> bool {
+  using Clock = std::chrono::steady_clock;
+  constexpr auto POLL_INTERVAL = std::chrono::milliseconds(5);
+  const auto give_up = Clock::now() + std::chrono::seconds(30);
+  while (counter.load(std::memory_order_relaxed) < expected) {
+    if (Clock::now() > give_up) {
+      return false;
+    }
+    std::this_thread::sleep_for(POLL_INTERVAL);
+  }
+  const auto quiet_until = Clock::now() + std::chrono::milliseconds(200);
+  while (Clock::now() < quiet_until) {
+    if (counter.load(std::memory_order_relaxed) != expected) {
+      return false;
+    }
+    std::this_thread::sleep_for(POLL_INTERVAL);
+  }
+  return true;
+}
+
+auto check(bool condition, const char *what) -> bool {
+  if (!condition) {
+    std::println("FAILED: {}", what);
+  }
+  return condition;
+}
+
+auto test_order_and_drain() -> bool {
+  std::FILE *file = std::tmpfile();
+  if (file == nullptr) {
+    return check(false, "tmpfile");
+  }
+  {
+    AsyncWriter writer(file, RING_CAPACITY);
+    for (size_t i = 0; i < NUM_BLOCKS; ++i) {
+      writer.write(numbered_block(i));
+      writer.write(std::string()); // Dropped, must not stop the writer
+    }
+  } // The destructor drains the ring
+  std::fflush(file);
+  const bool ok = check(file_contents(file) == expected_text(NUM_BLOCKS),
+                        "blocks out of order or lost at destruction");
+  std::fclose(file);
+  return ok;
+}
+
+// The writer thread may still be using the FILE after flush() returns, so
+// the test reads the file back through a second FILE of its own.
+auto test_flush() -> bool {
+  const std::filesystem::path path =
+      std::filesystem::temp_directory_path() / "async_writer_test.txt";
+  std::FILE *file = std::fopen(path.string().c_str(), "wb");
+  if (file == nullptr) {
+    return check(false, "fopen");
+  }
+  bool ok = true;
+  {
+    AsyncWriter writer(file, RING_CAPACITY);
+    for (size_t i = 0; i < NUM_BLOCKS && ok; ++i) {
+      writer.write(numbered_block(i));
+      if (i % 1000 == 999) {
+        writer.flush();
+        std::fflush(file); // The FILE has the blocks; push them to the file
+        std::FILE *reader = std::fopen(path.string().c_str(), "rb");
+        ok = check(reader != nullptr &&
+                       file_contents(reader) == expected_text(i + 1),
+                   "flush returned before its blocks were written");
+        if (reader != nullptr) {
+          std::fclose(reader);
+        }
+      }
+    }
+  }
+  std::fclose(file);
+  std::filesystem::remove(path);
+  return ok;
+}
+
+#if defined(ASYNC_WRITER_TEST_PIPE)
+// Each block alone is larger than any pipe buffer, so the writer thread
+// blocks inside its first fwrite until the reader below starts.
+constexpr size_t PIPE_BLOCK_BYTES = size_t{1} << 20;
+
+// Writes blocks of PIPE_BLOCK_BYTES through a writer with the given limits
+// into a pipe nobody reads yet: write() must stall after `stalls_after`
+// blocks, and everything must arrive in order once a reader starts.
+auto test_backpressure(size_t capacity, size_t max_bytes, size_t stalls_after,
+                       const char *what) -> bool {
+  int fds[2];
+  if (::pipe(fds) != 0) {
+    return check(false, "pipe");
+  }
+  std::FILE *sink = ::fdopen(fds[1], "w");
+  if (sink == nullptr) {
+    return check(false, "fdopen");
+  }
+  constexpr size_t BLOCKS = 8;
+  std::atomic<size_t> written{0};
+  bool ok = true;
+  std::string received;
+  std::jthread reader;
+  {
+    AsyncWriter writer(sink, capacity, max_bytes);
+    std::jthread producer([&] {
+      for (size_t i = 0; i < BLOCKS; ++i) {
+        writer.write(
+            std::string(PIPE_BLOCK_BYTES, static_cast<char>('a' + i)));
+        written.fetch_add(1, std::memory_order_relaxed);
+      }
+    });
+    ok = check(settles_at(written, stalls_after), what);
+
+    reader = std::jthread([&] {
+      std::string buffer(size_t{1} << 16, '\0');
+      ssize_t read = 0;
+      while ((read = ::read(fds[0], buffer.data(), buffer.size())) > 0) {
+        received.append(buffer.data(), static_cast<size_t>(read));
+      }
+    });
+    producer.join();
+  } // The writer drains the ring before it goes
+  std::fclose(sink); // End of file for the reader
+  reader.join();
+  ::close(fds[0]);
+  std::string expected;
+  for (size_t i = 0; i < BLOCKS; ++i) {
+    expected.append(PIPE_BLOCK_BYTES, static_cast<char>('a' + i));
+  }
+  return check(received == expected, "blocks lost or reordered behind "
+                                     "backpressure") &&
+         ok;
+}
+#endif
+
+auto main() -> int {
+  bool ok = test_order_and_drain();
+  ok = test_flush() && ok;
+#if defined(ASYNC_WRITER_TEST_PIPE)
+  // One block in the blocked fwrite plus one queued fill both slots
+  ok = test_backpressure(RING_CAPACITY, ASYNC_WRITER_MAX_BYTES, RING_CAPACITY,
+                         "write() did not wait for a full ring") &&
+       ok;
+  // The block in the blocked fwrite still counts: room for one more
+  ok = test_backpressure(64, 2 * PIPE_BLOCK_BYTES, 2,
+                         "write() did not wait at the byte limit") &&
+       ok;
+#endif
+  if (ok) {
+    std::println("AsyncWriter: all checks passed");
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,95 @@
+// append_student_row against the std::format it replaces: every row must come
+// out byte for byte the same. Covers edge values (zeros, rounding ties, NaN,
+// infinities, scores too wide for the column or for the to_chars buffer,
+// extreme ids) and a few million random rows. Exits non-zero on the first
+// mismatch.
+//
+//   clang++ -std=c++23 -O2 -I../src student_render_test.cpp
+#include <cmath>       // For std::pow
+#include <cstddef>     // For size_t
+#include <cstdint>     // For the fixed seed
+#include <format>      // For the reference rendering
+#include <limits>      // For edge values
+#include <print>       // C++23 printing
+#include <random>      // For random rows
+#include <string>      // For rendered rows
+#include <vector>      // For the edge cases
+
+#include "student.hpp"
+#include "student_render.hpp"
+
+constexpr size_t NUM_RANDOM_ROWS = size_t{1} << 21;
+constexpr std::uint64_t SEED = 20240501;
+
+// Whether `student` renders as the reference does; prints both if not.
+auto renders_like_format(const Student &student) -> bool {
+  std::string row;
+  append_student_row(row, student);
+  const std::string expected =
+      std::format("| {:<{}} | {:<{}.2f} |\n", student.id, RENDER_ID_WIDTH,
+                  student.score, RENDER_SCORE_WIDTH);
+  if (row != expected) {
+    std::print("Mismatch for id {}:\n  got      {}  expected {}", student.id,
+               row, expected);
+    return false;
+  }
+  return true;
+}
+
+auto main() -> int {
+  using Limits = std::numeric_limits<double>;
+  using IdLimits = std::numeric_limits<int>;
+  const std::vector<double> edge_scores{0.0,
+                                        -0.0,
+                                        0.004,
+                                        0.005,
+                                        0.015,
+                                        0.125,
+                                        -0.004,
+                                        99.995,
+                                        100.0,
+                                        -1.5,
+                                        123456789.125,
+                                        -1e15,
+                                        1e20,
+                                        1e300,
+                                        -1e300,
+                                        Limits::max(),
+                                        -Limits::max(),
+                                        Limits::min(),
+                                        Limits::denorm_min(),
+                                        Limits::infinity(),
+                                        -Limits::infinity(),
+                                        Limits::quiet_NaN(),
+                                        -Limits::quiet_NaN()};
+  const std::vector<int> edge_ids{0,          1,           -1,
+                                  999999999,  1000000000,  -999999999,
+                                  IdLimits::max(), IdLimits::min()};
+  size_t checked = 0;
+  for (const int id : edge_ids) {
+    for (const double score : edge_scores) {
+      if (!renders_like_format({.id = id, .score = score})) {
+        return 1;
+      }
+      checked++;
+    }
+  }
+
+  std::mt19937_64 engine(SEED);
+  std::uniform_int_distribution<int> ids(IdLimits::min(), IdLimits::max());
+  std::uniform_real_distribution<double> scores(-200.0, 200.0);
+  std::uniform_real_distribution<double> exponents(-30.0, 300.0);
+  for (size_t row = 0; row < NUM_RANDOM_ROWS; ++row) {
+    // Mostly scores in the program's range, some of any magnitude
+    const double score = row % 8 == 0
+                             ? std::pow(10.0, exponents(engine)) *
+                                   (row % 16 == 0 ? -1.0 : 1.0)
+                             : scores(engine);
+    if (!renders_like_format({.id = ids(engine), .score = score})) {
+      return 1;
+    }
+    checked++;
+  }
+  std::println("{} rows render as std::format does", checked);
+  return 0;
+}